@@ -0,0 +1,184 @@
+#include <spdlog/spdlog.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+#include "gorilla.hpp"
+#include "archive.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <winioctl.h>
+#endif // _WIN32
+
+namespace ipc = boost::interprocess;
+
+/**
+ * Let the file system allocate the file as it's written rather than as it grows, which NTFS only does for sparse
+ * files. Other file systems do it anyway.
+ */
+static auto MarkSparse(const std::filesystem::path &path) -> void {
+#ifdef _WIN32
+    const auto file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        spdlog::warn("Archive: Failed to open {} to make it sparse.", path.string());
+        return;
+    }
+    DWORD bytes = 0;
+    if (!DeviceIoControl(file, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &bytes, nullptr)) {
+        spdlog::warn("Archive: Failed to make {} sparse, segments are allocated as the file grows.", path.string());
+    }
+    CloseHandle(file);
+#else
+    (void) path;
+#endif // _WIN32
+}
+
+SeriesArchive::SeriesArchive(std::filesystem::path path) : m_Path(std::move(path)) {
+    std::ofstream(m_Path, std::ios::binary | std::ios::trunc);
+    MarkSparse(m_Path);
+}
+
+SeriesArchive::~SeriesArchive() {
+    m_Segments.clear();
+    std::error_code err;
+    std::filesystem::remove(m_Path, err);
+}
+
+template<class T>
+auto SeriesArchive::Append(const int64_t *times, const T *values, size_t count) -> bool {
+    if (count == 0 || count > CHUNK_SAMPLES) {
+        return false;
+    }
+    Gorilla::Encode(times, values, count, m_EncodeBuffer);
+    uint8_t *buffer = nullptr;
+    try {
+        buffer = Allocate(m_EncodeBuffer.size());
+    } catch (std::exception &err) {
+        spdlog::error("Archive: Failed to grow {}: {}", m_Path.string(), err.what());
+        return false;
+    }
+    std::memcpy(buffer, m_EncodeBuffer.data(), m_EncodeBuffer.size());
+
+    std::lock_guard<std::mutex> guard(m_Mutex);
+    const auto firstBucket = m_Summaries.size();
+    for (size_t first = 0; first < count; first += SUMMARY_SAMPLES) {
+        const auto last = std::min(first + SUMMARY_SAMPLES, count);
+        const auto [min, max] = std::minmax_element(values + first, values + last);
+        m_Summaries.push_back(SummaryBucket{times[first], static_cast<double>(*min), static_cast<double>(*max)});
+    }
+    m_Chunks.push_back(Chunk{m_Chunks.size(), times[0], times[count - 1], count, buffer, m_EncodeBuffer.size(),
+                             firstBucket, m_Summaries.size() - firstBucket});
+    m_Samples += count;
+    m_Bytes += m_EncodeBuffer.size();
+    return true;
+}
+
+auto SeriesArchive::Chunks(int64_t beginTime, int64_t endTime) const -> std::vector<Chunk> {
+    std::lock_guard<std::mutex> guard(m_Mutex);
+    const auto first = std::lower_bound(m_Chunks.begin(), m_Chunks.end(), beginTime,
+                                        [](const Chunk &chunk, int64_t time) { return chunk.m_LastTime < time; });
+    const auto last = std::upper_bound(first, m_Chunks.end(), endTime,
+                                       [](int64_t time, const Chunk &chunk) { return time < chunk.m_FirstTime; });
+    return std::vector<Chunk>(first, last);
+}
+
+template<class T>
+auto SeriesArchive::Decode(const Chunk &chunk) const -> std::shared_ptr<const DecodedChunk<T>> {
+    {
+        std::lock_guard<std::mutex> guard(m_Mutex);
+        const auto it = std::find_if(m_DecodedCache.begin(), m_DecodedCache.end(),
+                                     [&](const auto &entry) { return entry.first == chunk.m_Index; });
+        if (it != m_DecodedCache.end()) {
+            std::rotate(it, it + 1, m_DecodedCache.end());
+            return std::static_pointer_cast<const DecodedChunk<T>>(m_DecodedCache.back().second);
+        }
+    }
+    auto decoded = std::make_shared<DecodedChunk<T>>();
+    decoded->m_Times.resize(chunk.m_Count);
+    decoded->m_Values.resize(chunk.m_Count);
+    if (!Gorilla::Decode(chunk.m_Data, chunk.m_Bytes, chunk.m_Count,
+                         decoded->m_Times.data(), decoded->m_Values.data())) {
+        spdlog::error("Archive: Chunk {} of {} is corrupted", chunk.m_Index, m_Path.string());
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> guard(m_Mutex);
+    if (m_DecodedCache.size() == DECODED_CACHE_SIZE) {
+        m_DecodedCache.erase(m_DecodedCache.begin());
+    }
+    m_DecodedCache.emplace_back(chunk.m_Index, decoded);
+    return decoded;
+}
+
+template<class T>
+auto SeriesArchive::Summarize(const Chunk &chunk, size_t buckets) const -> std::shared_ptr<const DecodedChunk<T>> {
+    const auto group = std::max<size_t>(SUMMARY_BUCKETS / std::max<size_t>(buckets, 1), 1);
+    auto summary = std::make_shared<DecodedChunk<T>>();
+    summary->m_Times.reserve(2 * ((chunk.m_BucketCount + group - 1) / group));
+    summary->m_Values.reserve(summary->m_Times.capacity());
+    std::lock_guard<std::mutex> guard(m_Mutex);
+    for (size_t first = 0; first < chunk.m_BucketCount; first += group) {
+        const auto last = std::min(first + group, chunk.m_BucketCount);
+        auto min = m_Summaries[chunk.m_FirstBucket + first].m_Min;
+        auto max = m_Summaries[chunk.m_FirstBucket + first].m_Max;
+        for (auto bucket = first + 1; bucket < last; ++bucket) {
+            min = std::min(min, m_Summaries[chunk.m_FirstBucket + bucket].m_Min);
+            max = std::max(max, m_Summaries[chunk.m_FirstBucket + bucket].m_Max);
+        }
+        summary->m_Times.insert(summary->m_Times.end(), 2, m_Summaries[chunk.m_FirstBucket + first].m_Time);
+        summary->m_Values.push_back(static_cast<T>(min));
+        summary->m_Values.push_back(static_cast<T>(max));
+    }
+    return summary;
+}
+
+template auto SeriesArchive::Append(const int64_t *, const int16_t *, size_t) -> bool;
+template auto SeriesArchive::Append(const int64_t *, const int32_t *, size_t) -> bool;
+template auto SeriesArchive::Append(const int64_t *, const float *, size_t) -> bool;
+template auto SeriesArchive::Append(const int64_t *, const double *, size_t) -> bool;
+template auto SeriesArchive::Decode(const Chunk &) const -> std::shared_ptr<const DecodedChunk<int16_t>>;
+template auto SeriesArchive::Decode(const Chunk &) const -> std::shared_ptr<const DecodedChunk<int32_t>>;
+template auto SeriesArchive::Decode(const Chunk &) const -> std::shared_ptr<const DecodedChunk<float>>;
+template auto SeriesArchive::Decode(const Chunk &) const -> std::shared_ptr<const DecodedChunk<double>>;
+template auto SeriesArchive::Summarize(const Chunk &, size_t) const -> std::shared_ptr<const DecodedChunk<int16_t>>;
+template auto SeriesArchive::Summarize(const Chunk &, size_t) const -> std::shared_ptr<const DecodedChunk<int32_t>>;
+template auto SeriesArchive::Summarize(const Chunk &, size_t) const -> std::shared_ptr<const DecodedChunk<float>>;
+template auto SeriesArchive::Summarize(const Chunk &, size_t) const -> std::shared_ptr<const DecodedChunk<double>>;
+
+auto SeriesArchive::Samples() const -> uint64_t {
+    std::lock_guard<std::mutex> guard(m_Mutex);
+    return m_Samples;
+}
+
+auto SeriesArchive::Bytes() const -> uint64_t {
+    std::lock_guard<std::mutex> guard(m_Mutex);
+    return m_Bytes;
+}
+
+auto SeriesArchive::Path() const -> const std::filesystem::path & {
+    return m_Path;
+}
+
+auto SeriesArchive::Allocate(size_t bytes) -> uint8_t * {
+    if (m_Segments.empty() || m_SegmentUsed + bytes > m_SegmentBytes) {
+        auto segmentBytes = m_Segments.empty() ? MIN_SEGMENT_BYTES : std::min(m_SegmentBytes * 2, MAX_SEGMENT_BYTES);
+        while (segmentBytes < bytes) {
+            segmentBytes *= 2;
+        }
+        const auto offset = m_FileBytes;
+        std::filesystem::resize_file(m_Path, offset + segmentBytes);
+        ipc::file_mapping file(m_Path.string().c_str(), ipc::read_write);
+        m_Segments.push_back(std::make_unique<ipc::mapped_region>(file, ipc::read_write, offset, segmentBytes));
+        m_FileBytes = offset + segmentBytes;
+        m_SegmentBytes = segmentBytes;
+        m_SegmentUsed = 0;
+    }
+    auto *buffer = static_cast<uint8_t *>(m_Segments.back()->get_address()) + m_SegmentUsed;
+    m_SegmentUsed += bytes;
+    return buffer;
+}
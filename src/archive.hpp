@@ -0,0 +1,125 @@
+#ifndef BUSPLOT_ARCHIVE_HPP
+#define BUSPLOT_ARCHIVE_HPP
+
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Append-only on-disk history of a series.
+ *
+ * Samples are sealed in chunks of at most CHUNK_SAMPLES consecutive samples, compressed with Gorilla and written
+ * into a memory-mapped file, which grows by segments, from MIN_SEGMENT_BYTES doubling up to MAX_SEGMENT_BYTES, so
+ * that archiving many series doesn't reserve much disk space up front. The file is sparse on Windows too, where
+ * growing it would otherwise allocate the whole segment on disk. A segment stays mapped until the archive
+ * is destroyed, so chunks are decoded straight from the mapping: the OS pages them in and out of its page cache
+ * as needed instead of keeping them on the heap. The file is removed when the archive is destroyed.
+ * The last DECODED_CACHE_SIZE decoded chunks are cached, as consecutive frames usually look at the same range.
+ * Every chunk is also summarized in memory by the minimum and maximum of each SUMMARY_SAMPLES consecutive samples,
+ * so long ranges are drawn without decoding any chunk.
+ *
+ * Append must always be called from the same thread, Chunks and Decode may be called from any thread.
+ * An archive holds the samples of a single series, so Append and Decode must always use the same value type.
+ */
+class SeriesArchive {
+public:
+    static constexpr size_t CHUNK_SAMPLES = 4096;
+    static constexpr size_t MIN_SEGMENT_BYTES = size_t(1) << 20; ///< A multiple of any mapping granularity
+    static constexpr size_t MAX_SEGMENT_BYTES = size_t(48) << 20;
+    static constexpr size_t DECODED_CACHE_SIZE = 64;
+    static constexpr size_t SUMMARY_SAMPLES = 64;
+    static constexpr size_t SUMMARY_BUCKETS = CHUNK_SAMPLES / SUMMARY_SAMPLES; ///< Summary buckets of a full chunk
+
+    /**
+     * A sealed chunk, its compressed data points into the mapped file.
+     */
+    struct Chunk {
+        size_t m_Index;
+        int64_t m_FirstTime;
+        int64_t m_LastTime;
+        size_t m_Count;
+        const uint8_t *m_Data;
+        size_t m_Bytes;
+        size_t m_FirstBucket;   ///< Summary buckets of the chunk
+        size_t m_BucketCount;
+    };
+
+    template<class T>
+    struct DecodedChunk {
+        std::vector<int64_t> m_Times;
+        std::vector<T> m_Values;
+    };
+
+    explicit SeriesArchive(std::filesystem::path path);
+
+    ~SeriesArchive();
+
+    SeriesArchive(const SeriesArchive &) = delete;
+
+    auto operator=(const SeriesArchive &) -> SeriesArchive & = delete;
+
+    /**
+     * Seal `count` samples (at most CHUNK_SAMPLES) newer than every archived one into a new chunk.
+     * @return false if the file couldn't be grown or mapped.
+     */
+    template<class T>
+    auto Append(const int64_t *times, const T *values, size_t count) -> bool;
+
+    /**
+     * Chunks holding samples in [beginTime, endTime], in time order.
+     */
+    [[nodiscard]] auto Chunks(int64_t beginTime, int64_t endTime) const -> std::vector<Chunk>;
+
+    /**
+     * Decompress a chunk, or get it from the cache of recently decoded chunks.
+     * @return nullptr if the chunk data is corrupted.
+     */
+    template<class T>
+    [[nodiscard]] auto Decode(const Chunk &chunk) const -> std::shared_ptr<const DecodedChunk<T>>;
+
+    /**
+     * Summary of a chunk in `buckets` buckets, a power of two up to SUMMARY_BUCKETS, without decoding it.
+     * Like pyramid buckets in views, each bucket is the minimum then the maximum of its samples, both at the
+     * timestamp of its first sample.
+     */
+    template<class T>
+    [[nodiscard]] auto Summarize(const Chunk &chunk, size_t buckets) const -> std::shared_ptr<const DecodedChunk<T>>;
+
+    [[nodiscard]] auto Samples() const -> uint64_t;
+
+    /**
+     * Compressed size of the archived samples.
+     */
+    [[nodiscard]] auto Bytes() const -> uint64_t;
+
+    [[nodiscard]] auto Path() const -> const std::filesystem::path &;
+
+private:
+    struct SummaryBucket {
+        int64_t m_Time;
+        double m_Min;
+        double m_Max;
+    };
+
+    auto Allocate(size_t bytes) -> uint8_t *;
+
+    std::filesystem::path m_Path;
+    std::vector<std::unique_ptr<boost::interprocess::mapped_region>> m_Segments;
+    size_t m_SegmentUsed = 0;
+    size_t m_SegmentBytes = 0;
+    uint64_t m_FileBytes = 0;
+    std::vector<uint8_t> m_EncodeBuffer;
+    mutable std::mutex m_Mutex;
+    std::vector<Chunk> m_Chunks;
+    std::vector<SummaryBucket> m_Summaries;
+    uint64_t m_Samples = 0;
+    uint64_t m_Bytes = 0;
+    mutable std::vector<std::pair<size_t, std::shared_ptr<const void>>> m_DecodedCache; ///< Most recent last
+};
+
+#endif // BUSPLOT_ARCHIVE_HPP
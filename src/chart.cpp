@@ -1,135 +1,417 @@
 #include <fmt/format.h>
+#include <spdlog/spdlog.h>
 
 #include <memory>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 #include "gl.hpp"
 #include "chart.hpp"
 
-auto Chart::AddSeries(uint16_t seriesId) -> std::shared_ptr<Series> {
-    auto series = std::make_shared<Series>(fmt::format("var{}", seriesId));
+Chart::~Chart() {
+    SetArchiving(false);
+}
+
+auto Chart::AddSeries(uint16_t seriesId) -> std::shared_ptr<SeriesBase> {
+    auto series = std::make_shared<Series<float>>(DefaultLabel(seriesId));
     return AddSeries(seriesId, series)
            ? series
            : nullptr;
 }
 
-auto Chart::AddSeries(uint16_t seriesId, const std::shared_ptr<Series> &series) -> bool {
-    std::lock_guard<std::mutex> guard(m_Mutex);
-    return m_Series.insert(std::make_pair(seriesId, series)).second;
+auto Chart::AddSeries(uint16_t seriesId, const std::shared_ptr<SeriesBase> &series) -> bool {
+    return m_Series.Insert(seriesId, series);
 }
 
-auto Chart::GetSeriesOrDefault(uint16_t seriesId) const noexcept -> std::shared_ptr<Series> {
-    auto it = m_Series.find(seriesId);
-    return it == m_Series.end() ? nullptr : it->second;
+auto Chart::GetSeriesOrDefault(uint16_t seriesId) const noexcept -> std::shared_ptr<SeriesBase> {
+    return m_Series.Find(seriesId);
 }
 
-auto Chart::GetOrAddSeries(uint16_t seriesId) -> std::shared_ptr<Series> {
-    auto it = m_Series.find(seriesId);
-    if (it == m_Series.end()) {
-        return AddSeries(seriesId);
+auto Chart::GetOrAddSeries(uint16_t seriesId) -> SeriesBase * {
+    if (const auto &series = m_Series.Find(seriesId)) {
+        return series.get();
     }
-    return it->second;
+    return AddSeries(seriesId).get();
 }
 
 auto Chart::RemoveSeries(uint16_t seriesId) -> bool {
-    return m_Series.erase(seriesId);
+    return m_Series.Erase(seriesId);
+}
+
+auto Chart::DefaultLabel(uint16_t seriesId) -> std::string {
+    return fmt::format("var{}", seriesId);
+}
+
+auto Chart::ReplaceSeries(uint16_t seriesId, const std::shared_ptr<SeriesBase> &series) -> void {
+    m_Series.Assign(seriesId, series);
 }
 
 auto Chart::RenderPlot() -> void {
-    std::lock_guard<std::mutex> guard(m_Mutex);
-    auto timeLimit = m_TimeLimit.load();
-    const auto timeNow = std::chrono::time_point_cast<Duration>(Clock::now());
-    double xMin = std::chrono::duration_cast<Duration>(
-            (timeNow - timeLimit + m_TimeZoneDiff).time_since_epoch()).count();
-    double xMax = std::chrono::duration_cast<Duration>((timeNow + m_TimeZoneDiff).time_since_epoch()).count();
-    xMin /= 1000000.f;
-    xMax /= 1000000.f;
-    ImPlot::FitNextPlotAxes(false, true);
-    ImPlot::SetNextPlotLimitsX(xMin, xMax, ImGuiCond_Always);
+    const auto frozen = m_Frozen.load();
+    m_GpuLines.NewFrame();
+    const auto gpuLines = m_GpuLinesEnabled.load();
+    if (!frozen) {
+        auto timeLimit = m_TimeLimit.load();
+        const auto timeNow = std::chrono::time_point_cast<Duration>(Clock::now());
+        double xMin = std::chrono::duration_cast<Duration>((timeNow - timeLimit).time_since_epoch()).count();
+        double xMax = std::chrono::duration_cast<Duration>(timeNow.time_since_epoch()).count();
+        xMin /= 1000000.f;
+        xMax /= 1000000.f;
+        ImPlot::FitNextPlotAxes(false, true);
+        ImPlot::SetNextPlotLimitsX(xMin, xMax, ImGuiCond_Always);
+    }
     if (ImPlot::BeginPlot("##RealtimeGraph", nullptr, nullptr, ImVec2(-1, -1), ImPlotFlags_None,
                           ImPlotAxisFlags_Time)) {
-        for (const auto &item : m_Series) {
-            const auto &series = item.second;
-            auto buffer = series->GenerateDots(timeNow - timeLimit, timeNow);
-            if (!buffer.empty()) {
-                for (auto &dot : buffer) {
-                    dot.m_Time += std::chrono::duration_cast<std::chrono::seconds>(m_TimeZoneDiff).count();
-                }
-                const Dot *beginPtr = &buffer.front();
-                ImPlot::PlotLine(series->Label().c_str(),
-                                 &beginPtr->m_Time,
-                                 &beginPtr->m_Value,
-                                 buffer.size(),
-                                 0,
-                                 sizeof(Dot));
+        // Only the range shown is loaded, the user pans and zooms it while frozen.
+        const auto limits = ImPlot::GetPlotLimits().X;
+        const auto beginTime = TimeType(Duration(static_cast<Timestamp>(std::floor(limits.Min * 1000000.))));
+        const auto endTime = TimeType(Duration(static_cast<Timestamp>(std::ceil(limits.Max * 1000000.))));
+        const auto columns = static_cast<size_t>(ImPlot::GetPlotSize().x);
+        const auto downsampling = m_Downsampling.load();
+        const auto resolution = downsampling != Downsampling::Off ? columns * DOWNSAMPLING_OVERSAMPLING : columns;
+        const auto snapshot = m_Series.GetSnapshot();
+        m_PlotPreparer.Submit(snapshot, PlotPreparer::Request{beginTime, endTime, columns, resolution,
+                                                              downsampling, !frozen});
+        for (const auto &entry : *snapshot) {
+            const auto label = entry.m_Series->Label();
+            if (gpuLines && VisitSeries(*entry.m_Series, [&](const auto &typed) {
+                return m_GpuLines.Plot(label.c_str(), typed, beginTime, endTime);
+            })) {
+                continue;
+            }
+            const auto &points = m_PlotPreparer.Acquire(entry.m_Series.get());
+            if (!points.empty()) {
+                ImPlot::PlotLine(label.c_str(), &points[0].m_X, &points[0].m_Y, static_cast<int>(points.size()), 0,
+                                 sizeof(SamplePoint));
             }
         }
         ImPlot::EndPlot();
     }
 }
 
-auto Chart::Sparkline(const char *id, Series &series, const ImVec4 &col, const ImVec2 &size) -> void {
-    ImPlot::PushStyleVar(ImPlotStyleVar_PlotPadding, ImVec2(0, 0));
-    auto timeLimit = m_TimeLimit.load();
+auto Chart::UpdateSparkline(SparklineCache &cache, const SeriesBase &series, size_t columns,
+                            const TimeType &endTime) -> bool {
+    const auto beginTime = endTime - m_TimeLimit.load();
+    const auto xMin = static_cast<double>(beginTime.time_since_epoch().count()) / 1000000.;
+    const auto xMax = static_cast<double>(endTime.time_since_epoch().count()) / 1000000.;
+    bool intact = false;
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS && !intact; ++attempt) {
+        VisitSeries(series, [&](const auto &typed) {
+            const auto view = typed.View(beginTime, endTime, columns * DOWNSAMPLING_OVERSAMPLING);
+            const auto getPoint = [&](size_t point) {
+                return SamplePoint{static_cast<double>(view.TimeAt(point)) / 1000000.,
+                                   static_cast<double>(view.ValueAt(point))};
+            };
+            DownsampleM4(view.Size(), getPoint, xMin, xMax, columns, m_DownsampleBuffer);
+            intact = view.IsIntact();
+        });
+    }
+    if (!intact) {
+        return false;
+    }
+
+    cache.m_BeginTime = beginTime;
+    cache.m_EndTime = endTime;
+    cache.m_Line.clear();
+    cache.m_Fill.assign(columns, ImVec2(1.f, 0.f));
+    if (m_DownsampleBuffer.empty()) {
+        return true;
+    }
+    auto yMin = m_DownsampleBuffer.front().m_Y;
+    auto yMax = yMin;
+    for (const auto &point : m_DownsampleBuffer) {
+        yMin = std::min(yMin, point.m_Y);
+        yMax = std::max(yMax, point.m_Y);
+    }
+    const auto toY = [&](double y) {
+        return yMax > yMin ? static_cast<float>((yMax - y) / (yMax - yMin)) : 0.5f;
+    };
+    const auto baseline = std::clamp(toY(0.), 0.f, 1.f);
+    for (const auto &point : m_DownsampleBuffer) {
+        const auto x = static_cast<float>((point.m_X - xMin) / (xMax - xMin));
+        const auto y = toY(point.m_Y);
+        cache.m_Line.emplace_back(x, y);
+        const auto column = static_cast<int64_t>(std::floor(x * static_cast<float>(columns)));
+        if (column >= 0 && column < static_cast<int64_t>(columns)) {
+            auto &fill = cache.m_Fill[column];
+            fill.x = std::min({fill.x, y, baseline});
+            fill.y = std::max({fill.y, y, baseline});
+        }
+    }
+    return true;
+}
+
+auto Chart::Sparkline(uint16_t seriesId, const SeriesBase &series, uint64_t samples, const ImVec4 &col,
+                      const ImVec2 &size) -> void {
+    const auto origin = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(size);
+    if (!ImGui::IsItemVisible() || size.x < 1.f || size.y < 1.f) {
+        return;
+    }
+    const auto columns = static_cast<size_t>(size.x);
+    auto &cache = m_Sparklines[seriesId];
+    const auto timeLimit = m_TimeLimit.load();
     const auto timeNow = std::chrono::time_point_cast<Duration>(Clock::now());
-    double xMin = std::chrono::duration_cast<Duration>(
-            (timeNow - timeLimit + m_TimeZoneDiff).time_since_epoch()).count();
-    double xMax = std::chrono::duration_cast<Duration>((timeNow + m_TimeZoneDiff).time_since_epoch()).count();
-    xMin /= 1000000.f;
-    xMax /= 1000000.f;
-    ImPlot::FitNextPlotAxes(false, true);
-    ImPlot::SetNextPlotLimitsX(xMin, xMax, ImGuiCond_Always);
-    if (ImPlot::BeginPlot(id, nullptr, nullptr, size,
-                          ImPlotFlags_CanvasOnly | ImPlotFlags_NoChild,
-                          ImPlotAxisFlags_NoDecorations | ImPlotAxisFlags_Time,
-                          ImPlotAxisFlags_NoDecorations)) {
-        auto dots = series.GenerateDots(timeNow - timeLimit, timeNow);
-        if (!dots.empty()) {
-            for (auto &dot : dots) {
-                dot.m_Time += std::chrono::duration_cast<std::chrono::seconds>(m_TimeZoneDiff).count();
-            }
-            const auto &beginDot = dots.front();
-            ImPlot::PushStyleColor(ImPlotCol_Line, col);
-            ImPlot::PlotLine(id, &beginDot.m_Time, &beginDot.m_Value, dots.size(), 0, sizeof(Dot));
-            ImPlot::PushStyleVar(ImPlotStyleVar_FillAlpha, 0.25f);
-            ImPlot::PlotShaded(id, &beginDot.m_Time, &beginDot.m_Value, dots.size(), 0, 0, sizeof(Dot));
-            ImPlot::PopStyleVar();
-            ImPlot::PopStyleColor();
+    const auto columnTime = timeLimit / static_cast<Duration::rep>(columns);
+    if ((cache.m_Series != &series || cache.m_Samples != samples || cache.m_Columns != columns
+         || cache.m_EndTime - cache.m_BeginTime != timeLimit || timeNow - cache.m_EndTime >= columnTime)
+        && UpdateSparkline(cache, series, columns, timeNow)) {
+        cache.m_Series = &series;
+        cache.m_Samples = samples;
+        cache.m_Columns = columns;
+    }
+    cache.m_Frame = ImGui::GetFrameCount();
+
+    auto *drawList = ImGui::GetWindowDrawList();
+    const auto fillColor = ImGui::GetColorU32(ImVec4(col.x, col.y, col.z, col.w * 0.25f));
+    const auto columnWidth = size.x / static_cast<float>(columns);
+    for (size_t column = 0; column < cache.m_Fill.size(); ++column) {
+        const auto &fill = cache.m_Fill[column];
+        if (fill.x < fill.y) {
+            const auto x = origin.x + static_cast<float>(column) * columnWidth;
+            drawList->AddRectFilled(ImVec2(x, origin.y + fill.x * size.y),
+                                    ImVec2(x + columnWidth, origin.y + fill.y * size.y), fillColor);
         }
-        ImPlot::EndPlot();
     }
-    ImPlot::PopStyleVar();
+    m_SparklinePoints.resize(cache.m_Line.size());
+    for (size_t i = 0; i < cache.m_Line.size(); ++i) {
+        m_SparklinePoints[i] = ImVec2(origin.x + cache.m_Line[i].x * size.x, origin.y + cache.m_Line[i].y * size.y);
+    }
+    drawList->PushClipRect(origin, ImVec2(origin.x + size.x, origin.y + size.y), true);
+    drawList->AddPolyline(m_SparklinePoints.data(), static_cast<int>(m_SparklinePoints.size()),
+                          ImGui::GetColorU32(col), ImDrawFlags_None, 1.f);
+    drawList->PopClipRect();
+}
+
+/**
+ * Columns of the signal table.
+ */
+enum TableColumn : int {
+    TableColumn_Variable,
+    TableColumn_Value,
+    TableColumn_Min,
+    TableColumn_Max,
+    TableColumn_Mean,
+    TableColumn_StdDev,
+    TableColumn_Plot,
+    TableColumn_Count,
+};
+
+/**
+ * Key of a series when the table is sorted by a numeric column. Series without a value sort first.
+ */
+static auto TableSortKey(const SeriesBase &series, int column) -> double {
+    constexpr auto NONE = -std::numeric_limits<double>::infinity();
+    if (column == TableColumn_Value) {
+        const auto value = series.LastValue();
+        return value ? *value : NONE;
+    }
+    const auto stats = series.Stats();
+    if (stats.m_Count == 0) {
+        return NONE;
+    }
+    switch (column) {
+        case TableColumn_Min:
+            return stats.m_Min;
+        case TableColumn_Max:
+            return stats.m_Max;
+        case TableColumn_Mean:
+            return stats.m_Mean;
+        case TableColumn_StdDev:
+        default:
+            return std::sqrt(stats.m_Variance);
+    }
+}
+
+auto Chart::CollectTableRows(const SeriesRegistry::Snapshot &snapshot) -> void {
+    m_TableRows.clear();
+    const auto *sortSpecs = ImGui::TableGetSortSpecs();
+    const auto sorted = sortSpecs && sortSpecs->SpecsCount > 0;
+    const auto column = sorted ? sortSpecs->Specs[0].ColumnIndex : -1;
+    const auto filtered = m_TableFilter.IsActive();
+    for (size_t entry = 0; entry < snapshot.size(); ++entry) {
+        const auto &series = *snapshot[entry].m_Series;
+        TableRow row{entry, 0., filtered || column == TableColumn_Variable ? series.Label() : std::string()};
+        if (filtered && !m_TableFilter.PassFilter(row.m_Label.c_str())) {
+            continue;
+        }
+        if (column > TableColumn_Variable) {
+            row.m_Key = TableSortKey(series, column);
+        }
+        m_TableRows.push_back(std::move(row));
+    }
+    if (!sorted) {
+        return; ///< Id order
+    }
+    const auto descending = sortSpecs->Specs[0].SortDirection == ImGuiSortDirection_Descending;
+    const auto less = [&](const TableRow &lhs, const TableRow &rhs) {
+        return column == TableColumn_Variable ? lhs.m_Label < rhs.m_Label : lhs.m_Key < rhs.m_Key;
+    };
+    std::stable_sort(m_TableRows.begin(), m_TableRows.end(), [&](const TableRow &lhs, const TableRow &rhs) {
+        return descending ? less(rhs, lhs) : less(lhs, rhs);
+    });
 }
 
 auto Chart::RenderTable(double scale) -> void {
-    std::lock_guard<std::mutex> guard(m_Mutex);
-    const ImGuiTableFlags tableFlags = ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_RowBg;
-    if (ImGui::BeginTable("##ReadtimeTable", 3, tableFlags, ImVec2(-1, 0))) {
+    m_TableFilterChanged = m_TableFilter.Draw(u8"过滤", -50.f * static_cast<float>(scale)) || m_TableFilterChanged;
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_RowBg
+                                       | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Sortable
+                                       | ImGuiTableFlags_SortTristate;
+    if (ImGui::BeginTable("##ReadtimeTable", TableColumn_Count, tableFlags, ImVec2(-1, -1))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
         ImGui::TableSetupColumn("Variable", ImGuiTableColumnFlags_WidthFixed, 75.0f * scale);
         ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_WidthFixed, 75.0f * scale);
-        ImGui::TableSetupColumn("Plot");
+        ImGui::TableSetupColumn("Min", ImGuiTableColumnFlags_WidthFixed, 75.0f * scale);
+        ImGui::TableSetupColumn("Max", ImGuiTableColumnFlags_WidthFixed, 75.0f * scale);
+        ImGui::TableSetupColumn("Mean", ImGuiTableColumnFlags_WidthFixed, 75.0f * scale);
+        ImGui::TableSetupColumn("StdDev", ImGuiTableColumnFlags_WidthFixed, 75.0f * scale);
+        ImGui::TableSetupColumn("Plot", ImGuiTableColumnFlags_NoSort);
         ImGui::TableHeadersRow();
         ImPlot::PushColormap(ImPlotColormap_Cool);
-        for (auto it = m_Series.cbegin(); it != m_Series.cend(); ++it) {
-            const auto &series = it->second;
-            const auto row = std::distance(m_Series.cbegin(), it);
-            ImGui::TableNextRow();
-            ImGui::TableSetColumnIndex(0);
-            ImGui::Text("%s", series->Label().c_str());
-            ImGui::TableSetColumnIndex(1);
-            if (series->Data().empty()) {
-                ImGui::Text(u8"NULL");
-            } else {
-                ImGui::Text("%.3f", series->Data().back().m_Value);
+        // Rows are only collected again when their order may have changed: the sort specs, the filter or the
+        // series did, or the keys they are sorted or filtered by may have, which is checked now and then.
+        auto snapshot = m_Series.GetSnapshot();
+        auto *sortSpecs = ImGui::TableGetSortSpecs();
+        const auto now = std::chrono::steady_clock::now();
+        const auto keyed = (sortSpecs && sortSpecs->SpecsCount > 0) || m_TableFilter.IsActive();
+        if (snapshot != m_TableSnapshot || m_TableFilterChanged || (sortSpecs && sortSpecs->SpecsDirty)
+            || (keyed && now - m_TableRowsTime >= TABLE_REFRESH_INTERVAL)) {
+            CollectTableRows(*snapshot);
+            m_TableSnapshot = std::move(snapshot);
+            m_TableRowsTime = now;
+            m_TableFilterChanged = false;
+            if (sortSpecs) {
+                sortSpecs->SpecsDirty = false;
+            }
+        }
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(m_TableRows.size()));
+        while (clipper.Step()) {
+            for (auto row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                RenderTableRow((*m_TableSnapshot)[m_TableRows[row].m_Entry], m_TableRows[row].m_Entry, scale);
             }
-            ImGui::TableSetColumnIndex(2);
-            ImGui::PushID(row);
-            Sparkline("##spark", *series, ImPlot::GetColormapColor(row), ImVec2(-1, 35.f * scale));
-            ImGui::PopID();
         }
         ImPlot::PopColormap();
         ImGui::EndTable();
     }
+    const auto frame = ImGui::GetFrameCount();
+    for (auto it = m_Sparklines.begin(); it != m_Sparklines.end();) {
+        it = it->second.m_Frame == frame ? std::next(it) : m_Sparklines.erase(it); ///< Removed or scrolled out
+    }
+}
+
+auto Chart::RenderTableRow(const SeriesRegistry::Entry &entry, size_t colorIndex, double scale) -> void {
+    const auto &series = entry.m_Series;
+    ImGui::TableNextRow();
+    ImGui::TableSetColumnIndex(TableColumn_Variable);
+    ImGui::Text("%s", series->Label().c_str());
+    ImGui::TableSetColumnIndex(TableColumn_Value);
+    if (const auto value = series->LastValue()) {
+        const auto integral = series->GetValueType() == ValueType::Int16
+                              || series->GetValueType() == ValueType::Int32;
+        ImGui::Text(integral ? "%.0f" : "%.3f", *value);
+    } else {
+        ImGui::Text(u8"NULL");
+    }
+    const auto stats = series->Stats();
+    if (stats.m_Count > 0) {
+        if (ImGui::IsItemHovered()) {
+            ImGui::BeginTooltip();
+            ImGui::Text("Samples: %llu", static_cast<unsigned long long>(stats.m_Count));
+            if (const auto archive = series->Archive()) {
+                ImGui::Text("Archived: %llu samples, %.1f MiB",
+                            static_cast<unsigned long long>(archive->Samples()),
+                            static_cast<double>(archive->Bytes()) / (1 << 20));
+            }
+            ImGui::Text("Last %llu samples:", static_cast<unsigned long long>(stats.m_WindowCount));
+            ImGui::Text("  Min: %.3f  Max: %.3f  Mean: %.3f",
+                        stats.m_WindowMin, stats.m_WindowMax, stats.m_WindowMean);
+            ImGui::EndTooltip();
+        }
+        ImGui::TableSetColumnIndex(TableColumn_Min);
+        ImGui::Text("%.3f", stats.m_Min);
+        ImGui::TableSetColumnIndex(TableColumn_Max);
+        ImGui::Text("%.3f", stats.m_Max);
+        ImGui::TableSetColumnIndex(TableColumn_Mean);
+        ImGui::Text("%.3f", stats.m_Mean);
+        ImGui::TableSetColumnIndex(TableColumn_StdDev);
+        ImGui::Text("%.3f", std::sqrt(stats.m_Variance));
+    }
+    ImGui::TableSetColumnIndex(TableColumn_Plot);
+    Sparkline(entry.m_Id, *series, stats.m_Count, ImPlot::GetColormapColor(static_cast<int>(colorIndex)),
+              ImVec2(ImGui::GetContentRegionAvail().x, 35.f * scale));
 }
 
 auto Chart::TimeLimit() const noexcept -> std::chrono::microseconds { return m_TimeLimit; }
 
+auto Chart::SetSeriesCapacity(size_t capacity) -> void {
+    SeriesBase::SetDefaultCapacity(capacity);
+    m_Series.ForEach([&](uint16_t, const std::shared_ptr<SeriesBase> &series) {
+        series->SetCapacity(capacity);
+    });
+}
+
+auto Chart::SetSeriesTimebase(Timebase timebase) -> void {
+    SeriesBase::SetDefaultTimebase(timebase);
+    m_Series.ForEach([&](uint16_t, const std::shared_ptr<SeriesBase> &series) {
+        series->SetTimebase(timebase);
+    });
+}
+
+auto Chart::SetArchiving(bool enabled) -> void {
+    const auto wasEnabled = m_Archiving.exchange(enabled);
+    if (enabled && wasEnabled) {
+        return;
+    }
+    if (m_ArchiveThread.joinable()) {
+        m_ArchiveThread.join(); ///< Either we are stopping it, or it stopped by itself after a failure
+    }
+    if (enabled) {
+        m_ArchiveThread = std::thread(&Chart::ArchiveLoop, this);
+    }
+}
+
+auto Chart::IsArchiving() const noexcept -> bool { return m_Archiving; }
+
+auto Chart::SetDownsampling(Downsampling downsampling) -> void { m_Downsampling = downsampling; }
+
+auto Chart::GetDownsampling() const noexcept -> Downsampling { return m_Downsampling; }
+
+auto Chart::SetFrozen(bool frozen) -> void { m_Frozen = frozen; }
+
+auto Chart::IsFrozen() const noexcept -> bool { return m_Frozen; }
+
+auto Chart::SetGpuLines(bool enabled) -> void { m_GpuLinesEnabled = enabled; }
+
+auto Chart::IsGpuLines() const noexcept -> bool { return m_GpuLinesEnabled; }
+
+auto Chart::ReleaseGpuResources() -> void { m_GpuLines.Release(); }
+
+auto Chart::SetRedrawCallback(std::function<void()> callback) -> void {
+    m_PlotPreparer.SetReadyCallback(std::move(callback));
+}
+
+auto Chart::ArchiveLoop() -> void {
+    std::error_code err;
+    const auto directory = std::filesystem::temp_directory_path(err) / "BusPlot";
+    std::filesystem::create_directories(directory, err);
+    const auto session = std::chrono::duration_cast<Duration>(Clock::now().time_since_epoch()).count();
+    size_t archiveCount = 0;
+    while (m_Archiving) {
+        const auto snapshot = m_Series.GetSnapshot();
+        for (const auto &[seriesId, series] : *snapshot) {
+            if (!series->Archive()) {
+                series->EnableArchive(directory / fmt::format("{}-{}-{}.bin", session, seriesId, archiveCount++));
+            }
+            if (!series->ArchivePending()) {
+                spdlog::error("Chart: Archiving failed, stop archiving.");
+                m_Archiving = false;
+                break;
+            }
+        }
+        std::this_thread::sleep_for(ARCHIVE_INTERVAL);
+    }
+}
+
@@ -5,22 +5,27 @@
 #include <string>
 #include <memory>
 #include <atomic>
+#include <thread>
+#include <filesystem>
+#include <vector>
+#include <functional>
 
 #include "gl.hpp"
 #include "series.hpp"
+#include "series_registry.hpp"
+#include "downsample.hpp"
+#include "gpu_lines.hpp"
+#include "plot_preparer.hpp"
 
 class Chart {
 public:
-    explicit Chart() {
-        const std::time_t epochPlus11h = 60 * 60 * 11;
-        const int local_time = localtime(&epochPlus11h)->tm_hour;
-        const int gm_time = gmtime(&epochPlus11h)->tm_hour;
-        m_TimeZoneDiff = std::chrono::hours(local_time - gm_time);
-    };
+    explicit Chart() = default;
+
+    ~Chart();
 
-    auto AddSeries(uint16_t seriesId) -> std::shared_ptr<Series>;
+    auto AddSeries(uint16_t seriesId) -> std::shared_ptr<SeriesBase>;
 
-    auto AddSeries(uint16_t seriesId, const std::shared_ptr<Series> &series) -> bool;
+    auto AddSeries(uint16_t seriesId, const std::shared_ptr<SeriesBase> &series) -> bool;
 
     template<typename T>
     auto SetTimeLimit(T timeLimit) -> void {
@@ -29,9 +34,83 @@ public:
 
     [[nodiscard]] auto TimeLimit() const noexcept -> std::chrono::microseconds;
 
-    [[nodiscard]] auto GetSeriesOrDefault(uint16_t seriesId) const noexcept -> std::shared_ptr<Series>;
-
-    auto GetOrAddSeries(uint16_t seriesId) -> std::shared_ptr<Series>;
+    /**
+     * Stop the plot from following the newest samples, so the user can pan and zoom through the whole history
+     * while ingestion goes on. Only the range shown is loaded, at the level of detail of its pixel width.
+     */
+    auto SetFrozen(bool frozen) -> void;
+
+    [[nodiscard]] auto IsFrozen() const noexcept -> bool;
+
+    /**
+     * Set the sample capacity of every existing series and of the series created afterwards.
+     */
+    auto SetSeriesCapacity(size_t capacity) -> void;
+
+    /**
+     * Set the timebase of every existing series and of the series created afterwards.
+     */
+    auto SetSeriesTimebase(Timebase timebase) -> void;
+
+    /**
+     * Start or stop spilling the history of every series to memory-mapped files in the temporary directory.
+     */
+    auto SetArchiving(bool enabled) -> void;
+
+    [[nodiscard]] auto IsArchiving() const noexcept -> bool;
+
+    /**
+     * Set the reduction applied to the points of every series before they are plotted.
+     */
+    auto SetDownsampling(Downsampling downsampling) -> void;
+
+    [[nodiscard]] auto GetDownsampling() const noexcept -> Downsampling;
+
+    /**
+     * Draw the lines of the plot on the GPU from buffers only receiving the new samples, see GpuLineRenderer.
+     * Downsampling doesn't apply to them.
+     */
+    auto SetGpuLines(bool enabled) -> void;
+
+    [[nodiscard]] auto IsGpuLines() const noexcept -> bool;
+
+    /**
+     * Delete the OpenGL objects of the plot, before the OpenGL context is destroyed.
+     */
+    auto ReleaseGpuResources() -> void;
+
+    /**
+     * Set the function requesting a redraw when the plot points prepared in the background changed, see
+     * PlotPreparer::SetReadyCallback.
+     */
+    auto SetRedrawCallback(std::function<void()> callback) -> void;
+
+    /**
+     * Like GetOrAddSeries, the series are only looked up by id from the thread receiving the variables.
+     */
+    [[nodiscard]] auto GetSeriesOrDefault(uint16_t seriesId) const noexcept -> std::shared_ptr<SeriesBase>;
+
+    /**
+     * Get the series of a variable, a new one stores float values.
+     * Series are only added, replaced and removed by the thread receiving the variables, which may keep the
+     * returned pointer until it does so.
+     */
+    auto GetOrAddSeries(uint16_t seriesId) -> SeriesBase *;
+
+    /**
+     * Get the series of a variable storing T values, like GetOrAddSeries. A series of another value type is
+     * replaced by a new one with the same label: the variable changed type.
+     */
+    template<class T>
+    auto GetOrAddSeries(uint16_t seriesId) -> Series<T> * {
+        const auto &series = m_Series.Find(seriesId);
+        if (series && series->GetValueType() == ValueTypeOf<T>::VALUE) {
+            return static_cast<Series<T> *>(series.get());
+        }
+        auto typed = std::make_shared<Series<T>>(series ? series->Label() : DefaultLabel(seriesId));
+        ReplaceSeries(seriesId, typed);
+        return typed.get();
+    }
 
     auto RemoveSeries(uint16_t seriesId) -> bool;
 
@@ -40,13 +119,82 @@ public:
     auto RenderTable(double scale) -> void;
 
 private:
+    [[nodiscard]] static auto DefaultLabel(uint16_t seriesId) -> std::string;
+
+    auto ReplaceSeries(uint16_t seriesId, const std::shared_ptr<SeriesBase> &series) -> void;
+
+    /**
+     * Cached sparkline of a series: its M4-reduced polyline in normalized coordinates, (0, 0) being the top left
+     * corner of the sparkline and (1, 1) the bottom right one. It is only rebuilt when the series got new samples,
+     * the time range moved by a pixel column, or the sparkline or the time range got resized; otherwise drawing it
+     * only scales it into place.
+     */
+    struct SparklineCache {
+        const SeriesBase *m_Series = nullptr;
+        uint64_t m_Samples = 0;
+        size_t m_Columns = 0;
+        TimeType m_BeginTime;           ///< Time range it was built for
+        TimeType m_EndTime;
+        int m_Frame = 0;                ///< Last frame it was drawn
+        std::vector<ImVec2> m_Line;
+        std::vector<ImVec2> m_Fill;     ///< Top and bottom of the area shaded in each pixel column
+    };
+
+    /**
+     * A row of the signal table, `m_Key` and `m_Label` are only filled when sorting or filtering need them.
+     */
+    struct TableRow {
+        size_t m_Entry; ///< Index in the registry snapshot
+        double m_Key;
+        std::string m_Label;
+    };
+
+    /**
+     * Fill m_TableRows with the series passing the filter, in the order of the table sort specs, id order if
+     * there are none. RenderTable only calls it when the rows may have changed, see TABLE_REFRESH_INTERVAL.
+     */
+    auto CollectTableRows(const SeriesRegistry::Snapshot &snapshot) -> void;
+
+    auto RenderTableRow(const SeriesRegistry::Entry &entry, size_t colorIndex, double scale) -> void;
+
+    /**
+     * Rebuild the sparkline of a series over the time limit ending at `endTime`.
+     * @return false if the samples kept being overwritten while being read, the cache is left as it was then.
+     */
+    auto UpdateSparkline(SparklineCache &cache, const SeriesBase &series, size_t columns,
+                         const TimeType &endTime) -> bool;
+
+    /**
+     * Draw the sparkline of a series straight into the window draw list, without a plot.
+     * @param samples Number of samples the series got so far, the cached sparkline is rebuilt when it changes.
+     */
+    auto Sparkline(uint16_t seriesId, const SeriesBase &series, uint64_t samples, const ImVec4 &col,
+                   const ImVec2 &size) -> void;
+
+    auto ArchiveLoop() -> void;
 
-    auto Sparkline(const char *id, Series &series, const ImVec4 &col, const ImVec2 &size) -> void;
+    static constexpr auto ARCHIVE_INTERVAL = std::chrono::milliseconds(100);
+    static constexpr size_t DOWNSAMPLING_OVERSAMPLING = 16; ///< Points per pixel column fetched for downsampling
+    static constexpr int MAX_READ_ATTEMPTS = 3;             ///< Reads of a sparkline overwritten while read
+    static constexpr auto TABLE_REFRESH_INTERVAL = std::chrono::milliseconds(500); ///< Of rows sorted or filtered
 
-    mutable std::mutex m_Mutex;
-    std::unordered_map<int, std::shared_ptr<Series>> m_Series;
-    std::chrono::hours m_TimeZoneDiff{};
+    SeriesRegistry m_Series; ///< Changed by the thread receiving the variables, rendered from snapshots
     std::atomic<std::chrono::microseconds> m_TimeLimit{std::chrono::microseconds(5000000)};
+    std::atomic<bool> m_Archiving{false};
+    std::atomic<bool> m_Frozen{false};
+    std::atomic<Downsampling> m_Downsampling{Downsampling::M4};
+    std::vector<SamplePoint> m_DownsampleBuffer; ///< Only used by the render thread
+    std::atomic<bool> m_GpuLinesEnabled{false};
+    GpuLineRenderer m_GpuLines;                  ///< Only used by the render thread
+    PlotPreparer m_PlotPreparer;
+    std::unordered_map<uint16_t, SparklineCache> m_Sparklines;
+    std::vector<ImVec2> m_SparklinePoints;
+    ImGuiTextFilter m_TableFilter;
+    std::vector<TableRow> m_TableRows;
+    std::shared_ptr<const SeriesRegistry::Snapshot> m_TableSnapshot; ///< Snapshot m_TableRows were collected from
+    std::chrono::steady_clock::time_point m_TableRowsTime;           ///< When they were collected
+    bool m_TableFilterChanged = false;
+    std::thread m_ArchiveThread;
 };
 
 #endif // BUSPLOT_CHART_HPP
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "device_clock.hpp"
+
+DeviceClock::DeviceClock(uint32_t frequency) : m_Frequency(std::max<uint32_t>(frequency, 1)) {
+}
+
+auto DeviceClock::SetFrequency(uint32_t frequency) -> void {
+    m_Frequency = std::max<uint32_t>(frequency, 1);
+    Reset();
+}
+
+auto DeviceClock::Frequency() const noexcept -> uint32_t {
+    return m_Frequency;
+}
+
+auto DeviceClock::Reset() -> void {
+    m_Started = false;
+    m_LastTick = 0;
+    m_LastTicks = 0;
+    m_LastTime = 0;
+    m_Rate = 1;
+    m_Bounds.clear();
+    m_RoundTrips.clear();
+    m_Fitted = false;
+    m_FitTicks = 0;
+    m_FitTime = 0;
+    m_FitRate = 1;
+    m_Stats = SyncStats{};
+    m_PublishedStats.Store(m_Stats);
+}
+
+auto DeviceClock::Observe(uint32_t tick, const TimeType &receiveTime) -> void {
+    const auto receive = static_cast<double>(receiveTime.time_since_epoch().count());
+    auto ticks = Unwrap(tick);
+    if (!m_Started || CheckResync(ticks, receive)) {
+        Start(tick, receive);
+        ticks = 0;
+    }
+
+    const auto bound = receive - TicksToMicroseconds(ticks);
+    while (!m_Bounds.empty() && m_Bounds.back().m_Offset >= bound) {
+        m_Bounds.pop_back();
+    }
+    m_Bounds.push_back(Bound{receiveTime, bound});
+    while (m_Bounds.front().m_ReceiveTime < receiveTime - WINDOW) {
+        m_Bounds.pop_front();
+    }
+    Advance(ticks);
+}
+
+auto DeviceClock::AddRoundTrip(uint32_t tick, const TimeType &sendTime, const TimeType &receiveTime) -> void {
+    const auto duration = (receiveTime - sendTime).count();
+    if (duration < 0) {
+        return;
+    }
+    const auto midpoint = static_cast<double>(sendTime.time_since_epoch().count()) + static_cast<double>(duration) / 2;
+    auto ticks = Unwrap(tick);
+    if (!m_Started || CheckResync(ticks, midpoint)) {
+        Start(tick, midpoint);
+        ticks = 0;
+    }
+
+    m_RoundTrips.push_back(RoundTrip{ticks, midpoint, duration});
+    if (m_RoundTrips.size() > SYNC_WINDOW) {
+        m_RoundTrips.pop_front();
+    }
+    ++m_Stats.m_RoundTrips;
+    ++m_Stats.m_RoundTripHistogram[std::min<size_t>(static_cast<size_t>(duration / RTT_BIN_WIDTH.count()),
+                                                    RTT_BINS - 1)];
+    Fit();
+    Advance(ticks);
+}
+
+auto DeviceClock::ToHostTime(uint32_t tick) const -> TimeType {
+    return TimeType(Duration(std::llround(Map(Unwrap(tick)))));
+}
+
+auto DeviceClock::Stats() const noexcept -> SyncStats {
+    return m_PublishedStats.Load();
+}
+
+auto DeviceClock::Start(uint32_t tick, double hostTime) -> void {
+    if (m_Started) {
+        spdlog::info("DeviceClock: Tick {} is far from its mapping, mapping ticks from scratch", tick);
+    }
+    Reset();
+    m_Started = true;
+    m_LastTick = tick;
+    m_LastTime = hostTime;
+}
+
+auto DeviceClock::CheckResync(int64_t ticks, double hostTime) const noexcept -> bool {
+    return std::abs(hostTime - Map(ticks)) > static_cast<double>(RESYNC_THRESHOLD.count());
+}
+
+auto DeviceClock::Advance(int64_t ticks) -> void {
+    if (ticks <= m_LastTicks) {
+        return;
+    }
+    const auto elapsed = TicksToMicroseconds(ticks - m_LastTicks);
+    m_LastTime += elapsed * m_Rate;
+    m_LastTick += static_cast<uint32_t>(ticks - m_LastTicks);
+    m_LastTicks = ticks;
+    const auto maxStep = elapsed * MAX_SLEW;
+    m_LastTime += std::clamp(Estimate(ticks) - m_LastTime, -maxStep, maxStep);
+}
+
+auto DeviceClock::Fit() -> void {
+    std::vector<Timestamp> durations;
+    durations.reserve(m_RoundTrips.size());
+    for (const auto &roundTrip : m_RoundTrips) {
+        durations.push_back(roundTrip.m_Duration);
+    }
+    const auto median = durations.begin() + static_cast<ptrdiff_t>(durations.size() / 2);
+    std::nth_element(durations.begin(), median, durations.end());
+    m_Stats.m_MedianRoundTrip = *median;
+    const auto quartile = durations.begin() + static_cast<ptrdiff_t>(durations.size() / 4);
+    std::nth_element(durations.begin(), quartile, median);
+    const auto maxFitted = *quartile;
+    m_Stats.m_MinRoundTrip = *std::min_element(durations.begin(), quartile + 1);
+
+    // The rate is fitted to the midpoints, the faster a round trip the less its midpoint may be off. Least squares
+    // relative to the newest round trip, around the means of the round trips fitted.
+    const auto &newest = m_RoundTrips.back();
+    const auto fitted = [&](const RoundTrip &roundTrip) {
+        return roundTrip.m_Duration <= maxFitted;
+    };
+    size_t count = 0;
+    double meanX = 0, meanY = 0;
+    for (const auto &roundTrip : m_RoundTrips) {
+        if (fitted(roundTrip)) {
+            ++count;
+            meanX += TicksToMicroseconds(roundTrip.m_Ticks - newest.m_Ticks);
+            meanY += roundTrip.m_Midpoint - newest.m_Midpoint;
+        }
+    }
+    const auto n = static_cast<double>(count);
+    meanX /= n;
+    meanY /= n;
+    double sumXX = 0, sumXY = 0;
+    for (const auto &roundTrip : m_RoundTrips) {
+        if (fitted(roundTrip)) {
+            const auto x = TicksToMicroseconds(roundTrip.m_Ticks - newest.m_Ticks) - meanX;
+            sumXX += x * x;
+            sumXY += x * (roundTrip.m_Midpoint - newest.m_Midpoint - meanY);
+        }
+    }
+    if (count >= MIN_FIT_ROUND_TRIPS && sumXX > 0) {
+        auto rate = sumXY / sumXX;
+        // The midpoints are off by half the difference between the way there and back, which the bounds mostly
+        // cancel out. The rate is refined to the line through the offsets bounded by the older and newer halves of
+        // the round trips, each at its middle tick so that the rate it was bounded at barely matters.
+        const auto size = m_RoundTrips.size();
+        if (size >= 2 * MIN_FIT_ROUND_TRIPS) {
+            const auto half = size / 2;
+            const auto olderTicks = m_RoundTrips[half / 2].m_Ticks;
+            const auto newerTicks = m_RoundTrips[half + (size - half) / 2].m_Ticks;
+            for (int i = 0; i < REFINE_ITERATIONS; ++i) {
+                const auto [olderEarliest, olderLatest] = BoundTime(0, half, rate, olderTicks);
+                const auto [newerEarliest, newerLatest] = BoundTime(half, size, rate, newerTicks);
+                rate = ((newerEarliest + newerLatest) - (olderEarliest + olderLatest)) / 2
+                       / TicksToMicroseconds(newerTicks - olderTicks);
+            }
+        }
+        // Crystals are off by tens of ppm, a rate off by a percent is that of a wrong frequency.
+        if (std::abs(rate - 1) < 0.01) {
+            const auto [earliest, latest] = BoundTime(size - std::min(size, OFFSET_WINDOW), size, rate, newest.m_Ticks);
+            m_FitRate = rate;
+            m_FitTicks = newest.m_Ticks;
+            m_FitTime = (earliest + latest) / 2;
+            m_Rate = rate;
+            m_Fitted = true;
+            m_Stats.m_UncertaintyUs = std::max((latest - earliest) / 2, 0.);
+            m_Stats.m_DriftPpm = (1 / rate - 1) * 1e6;
+        }
+    }
+    m_Stats.m_Fitted = m_Fitted;
+    m_PublishedStats.Store(m_Stats);
+}
+
+auto DeviceClock::BoundTime(size_t first, size_t last, double rate, int64_t ticks) const noexcept
+        -> std::pair<double, double> {
+    // The tick of each round trip was taken after its request was sent and before its echo was received. At `rate`,
+    // the latest send and earliest receive bound the host time of `ticks`, within the fastest way there and back.
+    auto earliest = -std::numeric_limits<double>::infinity();
+    auto latest = std::numeric_limits<double>::infinity();
+    for (auto i = first; i < last; ++i) {
+        const auto &roundTrip = m_RoundTrips[i];
+        const auto time = roundTrip.m_Midpoint - rate * TicksToMicroseconds(roundTrip.m_Ticks - ticks);
+        const auto halfDuration = static_cast<double>(roundTrip.m_Duration) / 2;
+        earliest = std::max(earliest, time - halfDuration);
+        latest = std::min(latest, time + halfDuration);
+    }
+    return {earliest, latest};
+}
+
+auto DeviceClock::Map(int64_t ticks) const noexcept -> double {
+    return m_LastTime + TicksToMicroseconds(ticks - m_LastTicks) * m_Rate;
+}
+
+auto DeviceClock::Estimate(int64_t ticks) const noexcept -> double {
+    if (m_Fitted) {
+        return m_FitTime + TicksToMicroseconds(ticks - m_FitTicks) * m_FitRate;
+    }
+    if (!m_Bounds.empty()) {
+        return m_Bounds.front().m_Offset + TicksToMicroseconds(ticks);
+    }
+    return Map(ticks);
+}
+
+auto DeviceClock::Unwrap(uint32_t tick) const noexcept -> int64_t {
+    return m_LastTicks + static_cast<int32_t>(tick - m_LastTick);
+}
+
+auto DeviceClock::TicksToMicroseconds(int64_t ticks) const noexcept -> double {
+    return static_cast<double>(ticks) * 1e6 / static_cast<double>(m_Frequency);
+}
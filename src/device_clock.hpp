@@ -0,0 +1,153 @@
+#ifndef BUSPLOT_DEVICE_CLOCK_HPP
+#define BUSPLOT_DEVICE_CLOCK_HPP
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+#include "series.hpp"
+#include "seqlock.hpp"
+
+/**
+ * Maps the ticks of the device clock, sent with the samples, to host time.
+ *
+ * A frame is received some latency after the tick it carries, so that host time of its reception minus the time
+ * of its tick bounds the offset between both clocks from above, within the latency. Without round trips, the
+ * lowest bound over the last WINDOW, that of the frame received the fastest, is the estimated offset.
+ *
+ * Round trips measure both clocks better: the device stamps a request of the host with its tick, which is taken
+ * between the host sending the request and receiving the echo. A line fitted to the midpoints of the fastest
+ * quarter of the last SYNC_WINDOW round trips gives a first skew of the device clock, refined to the line through
+ * the offsets bounded by the older and newer halves of these round trips. The offset is taken halfway
+ * between the tightest bounds of the last OFFSET_WINDOW round trips at that skew: it is only off by the difference
+ * between the fastest way there and the fastest way back, which are close after a few round trips. The line
+ * supersedes the one-way bounds.
+ *
+ * The mapping follows the estimate by at most MAX_SLEW of the ticks elapsed, so that later ticks are always mapped
+ * to later times, except when the estimate jumps by more than RESYNC_THRESHOLD, e.g. because the device restarted.
+ * Mapped times may then step backwards, which Series::AddData absorbs by keeping its samples in time order.
+ *
+ * Ticks are 32 bits, which wrap around, and are unwrapped relative to the last tick observed.
+ * Only used by the thread receiving the samples, except Stats.
+ */
+class DeviceClock {
+public:
+    static constexpr uint32_t DEFAULT_FREQUENCY = 1000000;
+    static constexpr Duration WINDOW = std::chrono::seconds(4);
+    static constexpr size_t SYNC_WINDOW = 256;
+    static constexpr size_t OFFSET_WINDOW = 128;
+    static constexpr size_t MIN_FIT_ROUND_TRIPS = 8;
+    static constexpr int REFINE_ITERATIONS = 2;
+    static constexpr double MAX_SLEW = 0.001;
+    static constexpr Duration RESYNC_THRESHOLD = std::chrono::seconds(1);
+    static constexpr size_t RTT_BINS = 64;
+    static constexpr Duration RTT_BIN_WIDTH = std::chrono::microseconds(250);
+
+    struct SyncStats {
+        uint64_t m_RoundTrips;              ///< Since the mapping started
+        bool m_Fitted;                      ///< Ticks are mapped with the round trips
+        double m_DriftPpm;                  ///< How much faster the device clock runs than its frequency says
+        double m_UncertaintyUs;             ///< Half the distance between the bounds of the offset
+        Timestamp m_MinRoundTrip;           ///< Of the last SYNC_WINDOW round trips, in microseconds
+        Timestamp m_MedianRoundTrip;
+        uint32_t m_RoundTripHistogram[RTT_BINS]; ///< Round trips per RTT_BIN_WIDTH, the last bin counts longer ones
+    };
+
+    explicit DeviceClock(uint32_t frequency = DEFAULT_FREQUENCY);
+
+    /**
+     * Set the ticks per second of the device clock, and start mapping from scratch.
+     */
+    auto SetFrequency(uint32_t frequency) -> void;
+
+    [[nodiscard]] auto Frequency() const noexcept -> uint32_t;
+
+    /**
+     * Forget the ticks and round trips observed so far.
+     */
+    auto Reset() -> void;
+
+    /**
+     * Update the estimate with a frame received at `receiveTime` carrying `tick`, the newest tick of the frame.
+     */
+    auto Observe(uint32_t tick, const TimeType &receiveTime) -> void;
+
+    /**
+     * Update the estimate with a request sent at `sendTime`, stamped with `tick` by the device, and echoed back at
+     * `receiveTime`.
+     */
+    auto AddRoundTrip(uint32_t tick, const TimeType &sendTime, const TimeType &receiveTime) -> void;
+
+    /**
+     * Host time of a tick near the last one observed, before or after it.
+     */
+    [[nodiscard]] auto ToHostTime(uint32_t tick) const -> TimeType;
+
+    /**
+     * Statistics of the round trips, may be read from any thread.
+     */
+    [[nodiscard]] auto Stats() const noexcept -> SyncStats;
+
+private:
+    struct Bound {
+        TimeType m_ReceiveTime;
+        double m_Offset;                ///< Host time of unwrapped tick 0 in microseconds, at most
+    };
+
+    struct RoundTrip {
+        int64_t m_Ticks;                ///< Unwrapped
+        double m_Midpoint;              ///< Host time in microseconds
+        Timestamp m_Duration;
+    };
+
+    /**
+     * Start mapping `tick` to `hostTime`, in microseconds.
+     */
+    auto Start(uint32_t tick, double hostTime) -> void;
+
+    /**
+     * Whether `hostTime` of `ticks` is so far from its current mapping that mapping must start over.
+     */
+    [[nodiscard]] auto CheckResync(int64_t ticks, double hostTime) const noexcept -> bool;
+
+    /**
+     * Map ticks up to `ticks` at the current rate, then move the mapping towards the estimate.
+     */
+    auto Advance(int64_t ticks) -> void;
+
+    /**
+     * Fit the line of the round trips, and publish their statistics.
+     */
+    auto Fit() -> void;
+
+    /**
+     * Earliest and latest host time of `ticks` at `rate` that round trips [first, last) allow, in microseconds.
+     */
+    [[nodiscard]] auto BoundTime(size_t first, size_t last, double rate, int64_t ticks) const noexcept
+            -> std::pair<double, double>;
+
+    [[nodiscard]] auto Map(int64_t ticks) const noexcept -> double;
+
+    [[nodiscard]] auto Estimate(int64_t ticks) const noexcept -> double;
+
+    [[nodiscard]] auto Unwrap(uint32_t tick) const noexcept -> int64_t;
+
+    [[nodiscard]] auto TicksToMicroseconds(int64_t ticks) const noexcept -> double;
+
+    uint32_t m_Frequency;
+    bool m_Started = false;
+    uint32_t m_LastTick = 0;
+    int64_t m_LastTicks = 0;            ///< m_LastTick unwrapped
+    double m_LastTime = 0;              ///< Host time m_LastTicks is mapped to, in microseconds
+    double m_Rate = 1;                  ///< Host microseconds per microsecond of ticks
+    std::deque<Bound> m_Bounds;         ///< Offset bounds of the window, increasing, the lowest first
+    std::deque<RoundTrip> m_RoundTrips;
+    bool m_Fitted = false;
+    int64_t m_FitTicks = 0;             ///< The fitted line goes through (m_FitTicks, m_FitTime)
+    double m_FitTime = 0;
+    double m_FitRate = 1;
+    SyncStats m_Stats{};                ///< Only touched by the receiving thread
+    SeqLock<SyncStats> m_PublishedStats;
+};
+
+#endif // BUSPLOT_DEVICE_CLOCK_HPP
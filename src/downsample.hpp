@@ -0,0 +1,131 @@
+#ifndef BUSPLOT_DOWNSAMPLE_HPP
+#define BUSPLOT_DOWNSAMPLE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Reduction applied to the points of a series before they are plotted.
+ */
+enum class Downsampling {
+    Off,
+    M4,   ///< First, last, minimum and maximum point of each pixel column: draws the same pixels as every point
+    LTTB, ///< Largest-Triangle-Three-Buckets: keeps the visual shape with a fixed number of points
+};
+
+/**
+ * A point in plot coordinates.
+ */
+struct SamplePoint {
+    double m_X;
+    double m_Y;
+};
+
+/**
+ * M4 aggregation: keep the first, last, minimum and maximum point of every pixel column, in their original
+ * order. Drawing them as a line sets exactly the pixels the full line sets.
+ * @param getPoint Callable returning the SamplePoint at an index in [0, count), sorted by x.
+ * @param columns Number of pixel columns spanning [xMin, xMax]. Points outside of it are kept in one column on
+ * each side, so the line still enters and leaves the plot at the right place.
+ */
+template<class GetPoint>
+auto DownsampleM4(size_t count, const GetPoint &getPoint, double xMin, double xMax, size_t columns,
+                  std::vector<SamplePoint> &out) -> void {
+    out.clear();
+    if (count == 0 || columns == 0 || !(xMax > xMin)) {
+        return;
+    }
+    const auto scale = static_cast<double>(columns) / (xMax - xMin);
+    const auto columnOf = [&](double x) {
+        return std::clamp(static_cast<int64_t>(std::floor((x - xMin) * scale)),
+                          int64_t(-1), static_cast<int64_t>(columns));
+    };
+    auto point = getPoint(0);
+    for (size_t index = 0; index < count;) {
+        const auto column = columnOf(point.m_X);
+        size_t kept[4] = {index, index, index, index}; ///< First, minimum, maximum, last
+        SamplePoint keptPoints[4] = {point, point, point, point};
+        while (++index < count) {
+            point = getPoint(index);
+            if (columnOf(point.m_X) != column) {
+                break;
+            }
+            if (point.m_Y < keptPoints[1].m_Y) {
+                kept[1] = index;
+                keptPoints[1] = point;
+            }
+            if (point.m_Y > keptPoints[2].m_Y) {
+                kept[2] = index;
+                keptPoints[2] = point;
+            }
+            kept[3] = index;
+            keptPoints[3] = point;
+        }
+        if (kept[1] > kept[2]) {
+            std::swap(kept[1], kept[2]);
+            std::swap(keptPoints[1], keptPoints[2]);
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            if (i == 0 || kept[i] != kept[i - 1]) {
+                out.push_back(keptPoints[i]);
+            }
+        }
+    }
+}
+
+/**
+ * Largest-Triangle-Three-Buckets: keep the first and last point, and from each of `threshold - 2` buckets in
+ * between the point forming the largest triangle with the previously kept point and the average of the next
+ * bucket.
+ * @param getPoint Callable returning the SamplePoint at an index in [0, count).
+ */
+template<class GetPoint>
+auto DownsampleLTTB(size_t count, const GetPoint &getPoint, size_t threshold,
+                    std::vector<SamplePoint> &out) -> void {
+    out.clear();
+    if (threshold >= count || threshold < 3) {
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back(getPoint(i));
+        }
+        return;
+    }
+    const auto bucketSize = static_cast<double>(count - 2) / static_cast<double>(threshold - 2);
+    const auto bucketBegin = [&](size_t bucket) {
+        return std::min(static_cast<size_t>(static_cast<double>(bucket) * bucketSize) + 1, count - 1);
+    };
+    auto previous = getPoint(0);
+    out.push_back(previous);
+    for (size_t bucket = 0; bucket < threshold - 2; ++bucket) {
+        const auto nextBegin = bucketBegin(bucket + 1);
+        const auto nextEnd = std::max(bucketBegin(bucket + 2), nextBegin + 1);
+        double averageX = 0;
+        double averageY = 0;
+        for (auto i = nextBegin; i < nextEnd; ++i) {
+            const auto point = getPoint(i);
+            averageX += point.m_X;
+            averageY += point.m_Y;
+        }
+        averageX /= static_cast<double>(nextEnd - nextBegin);
+        averageY /= static_cast<double>(nextEnd - nextBegin);
+
+        double largestArea = -1;
+        SamplePoint selected = previous;
+        for (auto i = bucketBegin(bucket); i < nextBegin; ++i) {
+            const auto point = getPoint(i);
+            const auto area = std::abs((previous.m_X - averageX) * (point.m_Y - previous.m_Y) -
+                                       (previous.m_X - point.m_X) * (averageY - previous.m_Y));
+            if (area > largestArea) {
+                largestArea = area;
+                selected = point;
+            }
+        }
+        out.push_back(selected);
+        previous = selected;
+    }
+    out.push_back(getPoint(count - 1));
+}
+
+#endif // BUSPLOT_DOWNSAMPLE_HPP
@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <cstring>
+
+#include "crc.hpp"
+#include "frame_scanner.hpp"
+
+auto FrameScanner::Counters() const noexcept -> FrameCounters {
+    return FrameCounters{m_Frames.load(std::memory_order_relaxed), m_Recovered.load(std::memory_order_relaxed),
+                         m_Dropped.load(std::memory_order_relaxed), m_SkippedBytes.load(std::memory_order_relaxed)};
+}
+
+auto FrameScanner::Expect(uint16_t command, size_t minLength, size_t maxLength) -> void {
+    m_ExpectedLengths[command] = {minLength, maxLength};
+}
+
+auto FrameScanner::Next(Frame &frame) noexcept -> bool {
+    while (m_Begin < m_End) {
+        const auto *sof = static_cast<const uint8_t *>(std::memchr(m_Buffer + m_Begin, SOF, m_End - m_Begin));
+        const auto start = sof ? static_cast<size_t>(sof - m_Buffer) : m_End;
+        m_SkippedBytes.fetch_add(start - m_Begin, std::memory_order_relaxed);
+        m_Begin = start;
+        if (m_End - m_Begin < sizeof(SOF) + sizeof(FrameHeader)) {
+            return false;
+        }
+        FrameHeader header;
+        std::memcpy(&header, m_Buffer + m_Begin + sizeof(SOF), sizeof(header));
+        const auto frameBytes = sizeof(SOF) + sizeof(FrameHeader) + header.m_DataLength + sizeof(FrameTail);
+        bool expected = true;
+        if (!m_ExpectedLengths.empty()) {
+            const auto it = m_ExpectedLengths.find(header.m_Command);
+            expected = it != m_ExpectedLengths.end()
+                       && header.m_DataLength >= it->second.first && header.m_DataLength <= it->second.second;
+        }
+        if (expected && m_End - m_Begin < frameBytes) {
+            return false;
+        }
+        if (!expected || !CRC::VerifyCRC16Checksum(m_Buffer + m_Begin, frameBytes)) {
+            // Whatever follows the SOF may be the start of a frame: only the SOF is skipped.
+            const auto candidateBytes = expected ? frameBytes : sizeof(SOF) + sizeof(FrameHeader);
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+            m_SkippedBytes.fetch_add(sizeof(SOF), std::memory_order_relaxed);
+            m_RescanEnd = std::max(m_RescanEnd, m_Begin + candidateBytes);
+            m_Begin += sizeof(SOF);
+            continue;
+        }
+        frame = Frame{header.m_Command, m_Buffer + m_Begin + sizeof(SOF) + sizeof(FrameHeader), header.m_DataLength};
+        m_Frames.fetch_add(1, std::memory_order_relaxed);
+        if (m_Begin < m_RescanEnd) {
+            m_Recovered.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_Begin += frameBytes;
+        return true;
+    }
+    return false;
+}
+
+auto FrameScanner::Compact() noexcept -> void {
+    if (m_Begin == m_End) {
+        m_Begin = m_End = m_RescanEnd = 0;
+    } else if (WritableBytes() < MAX_FRAME_BYTES) {
+        std::memmove(m_Buffer, m_Buffer + m_Begin, m_End - m_Begin);
+        m_End -= m_Begin;
+        m_RescanEnd = m_RescanEnd > m_Begin ? m_RescanEnd - m_Begin : 0;
+        m_Begin = 0;
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef BUSPLOT_FRAME_SCANNER_HPP
+#define BUSPLOT_FRAME_SCANNER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+
+#include "rpc_protocol.hpp"
+
+/**
+ * Streaming parser of RPC frames: SOF, FrameHeader, body, FrameTail.
+ *
+ * Received bytes are read straight into the buffer of the scanner, as many as are available, then every complete
+ * frame in it is parsed in one pass. Bytes before a SOF are skipped, and an incomplete frame stays in the buffer
+ * until the rest of it is received, then moves to the front of the buffer when the buffer is nearly full. Frames
+ * are at most MAX_FRAME_BYTES long, so the buffer always has room for a large read.
+ *
+ * A candidate frame with an unexpected header or failing its CRC is either corrupted or started at a byte which
+ * merely equals SOF, and a real frame may start anywhere inside it. Only its SOF byte is skipped then, and the scan
+ * resumes right after it.
+ *
+ * Every method must be called from the same thread, except Counters.
+ */
+class FrameScanner {
+public:
+    static constexpr size_t CAPACITY = 64 * 1024;
+    static constexpr size_t MAX_FRAME_BYTES = sizeof(SOF) + sizeof(FrameHeader) + UINT8_MAX + sizeof(FrameTail);
+
+    struct Frame {
+        uint16_t m_Command;
+        const uint8_t *m_Body;  ///< Valid until the next Commit
+        size_t m_Length;
+    };
+
+    struct FrameCounters {
+        uint64_t m_Frames;          ///< Frames passing their CRC
+        uint64_t m_Recovered;       ///< Of m_Frames, those starting inside the header or body of a dropped candidate
+        uint64_t m_Dropped;         ///< Candidates dropped because of their header or CRC
+        uint64_t m_SkippedBytes;    ///< Bytes not part of any frame
+    };
+
+    /**
+     * Accept frames of `command` only if their body is `minLength` to `maxLength` bytes long. Once any command is
+     * expected, frames of other commands are dropped.
+     */
+    auto Expect(uint16_t command, size_t minLength, size_t maxLength) -> void;
+
+    auto Expect(uint16_t command, size_t length) -> void { Expect(command, length, length); }
+
+    /**
+     * Where to receive bytes, WritableBytes() of them at most.
+     */
+    [[nodiscard]] auto WritePointer() noexcept -> uint8_t * { return m_Buffer + m_End; }
+
+    [[nodiscard]] auto WritableBytes() const noexcept -> size_t { return CAPACITY - m_End; }
+
+    /**
+     * Append `bytes` bytes received at WritePointer().
+     */
+    auto Commit(size_t bytes) noexcept -> void { m_End += bytes; }
+
+    /**
+     * Call `handler(frame)` for every complete frame received, in order.
+     * @return The number of frames handled.
+     */
+    template<class Handler>
+    auto Scan(Handler &&handler) -> size_t {
+        size_t frames = 0;
+        Frame frame{};
+        while (Next(frame)) {
+            handler(static_cast<const Frame &>(frame));
+            ++frames;
+        }
+        Compact();
+        return frames;
+    }
+
+    /**
+     * Counters since construction, may be read from any thread.
+     */
+    [[nodiscard]] auto Counters() const noexcept -> FrameCounters;
+
+private:
+    /**
+     * Parse the next complete frame.
+     * @return false if there is none before the end of the received bytes.
+     */
+    auto Next(Frame &frame) noexcept -> bool;
+
+    /**
+     * Make room for a large read after the received bytes.
+     */
+    auto Compact() noexcept -> void;
+
+    uint8_t m_Buffer[CAPACITY]{};
+    size_t m_Begin = 0; ///< First byte not parsed yet
+    size_t m_End = 0;   ///< End of the received bytes
+    size_t m_RescanEnd = 0; ///< End of the dropped candidates
+    std::unordered_map<uint16_t, std::pair<size_t, size_t>> m_ExpectedLengths;   ///< Min and max body lengths
+    std::atomic<uint64_t> m_Frames{0};
+    std::atomic<uint64_t> m_Recovered{0};
+    std::atomic<uint64_t> m_Dropped{0};
+    std::atomic<uint64_t> m_SkippedBytes{0};
+};
+
+#endif // BUSPLOT_FRAME_SCANNER_HPP
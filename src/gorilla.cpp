@@ -0,0 +1,225 @@
+#include <cstring>
+#include <type_traits>
+
+#include "gorilla.hpp"
+
+/**
+ * Appends bits to a byte vector, most significant bit first.
+ */
+class GorillaBitWriter {
+public:
+    explicit GorillaBitWriter(std::vector<uint8_t> &out) : m_Out(out) {}
+
+    auto Write(uint64_t value, unsigned bits) -> void {
+        while (bits > 0) {
+            if (m_BitOffset == 0) {
+                m_Out.push_back(0);
+            }
+            const unsigned space = 8 - m_BitOffset;
+            const unsigned take = space < bits ? space : bits;
+            const auto part = static_cast<uint8_t>((value >> (bits - take)) & ((1u << take) - 1));
+            m_Out.back() |= static_cast<uint8_t>(part << (space - take));
+            bits -= take;
+            m_BitOffset = (m_BitOffset + take) % 8;
+        }
+    }
+
+private:
+    std::vector<uint8_t> &m_Out;
+    unsigned m_BitOffset = 0;
+};
+
+class GorillaBitReader {
+public:
+    GorillaBitReader(const uint8_t *data, size_t bytes) : m_Data(data), m_Bits(bytes * 8) {}
+
+    auto Read(unsigned bits) -> uint64_t {
+        if (m_Position + bits > m_Bits) {
+            m_Error = true;
+            m_Position = m_Bits;
+            return 0;
+        }
+        uint64_t value = 0;
+        while (bits > 0) {
+            const unsigned offset = m_Position % 8;
+            const unsigned available = 8 - offset;
+            const unsigned take = available < bits ? available : bits;
+            const auto byte = m_Data[m_Position / 8];
+            value = (value << take) | ((byte >> (available - take)) & ((1u << take) - 1));
+            bits -= take;
+            m_Position += take;
+        }
+        return value;
+    }
+
+    [[nodiscard]] auto Error() const noexcept -> bool { return m_Error; }
+
+private:
+    const uint8_t *m_Data;
+    size_t m_Bits;
+    size_t m_Position = 0;
+    bool m_Error = false;
+};
+
+/**
+ * Unsigned integer with the bit width of a value type.
+ */
+template<class T>
+using GorillaBits = std::conditional_t<sizeof(T) == 2, uint16_t,
+        std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>;
+
+/**
+ * Width of the fields holding a bit count in [0, bits).
+ */
+static constexpr auto CountFieldBits(unsigned bits) -> unsigned {
+    return bits <= 1 ? 0 : 1 + CountFieldBits(bits / 2);
+}
+
+template<class T>
+static auto ToBits(T value) -> GorillaBits<T> {
+    GorillaBits<T> bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+template<class T>
+static auto FromBits(GorillaBits<T> bits) -> T {
+    T value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template<class Bits>
+static auto LeadingZeros(Bits value) -> unsigned {
+    unsigned count = 0;
+    for (auto mask = static_cast<Bits>(Bits(1) << (sizeof(Bits) * 8 - 1)); mask != 0 && !(value & mask); mask >>= 1) {
+        ++count;
+    }
+    return count;
+}
+
+template<class Bits>
+static auto TrailingZeros(Bits value) -> unsigned {
+    unsigned count = 0;
+    for (Bits mask = 1; mask != 0 && !(value & mask); mask <<= 1) {
+        ++count;
+    }
+    return count;
+}
+
+template<class T>
+auto Gorilla::Encode(const int64_t *times, const T *values, size_t count, std::vector<uint8_t> &out) -> void {
+    constexpr unsigned BITS = sizeof(T) * 8;
+    constexpr unsigned COUNT_BITS = CountFieldBits(BITS);
+    out.clear();
+    if (count == 0) {
+        return;
+    }
+    GorillaBitWriter writer(out);
+    writer.Write(static_cast<uint64_t>(times[0]), 64);
+    writer.Write(ToBits(values[0]), BITS);
+
+    int64_t prevDelta = 0;
+    auto prevBits = ToBits(values[0]);
+    unsigned prevLeading = BITS; ///< No XOR window yet
+    unsigned prevTrailing = 0;
+    for (size_t i = 1; i < count; ++i) {
+        const auto delta = times[i] - times[i - 1];
+        const auto deltaOfDelta = delta - prevDelta;
+        prevDelta = delta;
+        if (deltaOfDelta == 0) {
+            writer.Write(0b0, 1);
+        } else if (deltaOfDelta >= -63 && deltaOfDelta <= 64) {
+            writer.Write(0b10, 2);
+            writer.Write(static_cast<uint64_t>(deltaOfDelta + 63), 7);
+        } else if (deltaOfDelta >= -255 && deltaOfDelta <= 256) {
+            writer.Write(0b110, 3);
+            writer.Write(static_cast<uint64_t>(deltaOfDelta + 255), 9);
+        } else if (deltaOfDelta >= -2047 && deltaOfDelta <= 2048) {
+            writer.Write(0b1110, 4);
+            writer.Write(static_cast<uint64_t>(deltaOfDelta + 2047), 12);
+        } else {
+            writer.Write(0b1111, 4);
+            writer.Write(static_cast<uint64_t>(deltaOfDelta), 64);
+        }
+
+        const auto bits = ToBits(values[i]);
+        const auto xorBits = static_cast<GorillaBits<T>>(bits ^ prevBits);
+        prevBits = bits;
+        if (xorBits == 0) {
+            writer.Write(0b0, 1);
+            continue;
+        }
+        const auto leading = LeadingZeros(xorBits);
+        const auto trailing = TrailingZeros(xorBits);
+        if (prevLeading < BITS && leading >= prevLeading && trailing >= prevTrailing) {
+            writer.Write(0b10, 2);
+            writer.Write(xorBits >> prevTrailing, BITS - prevLeading - prevTrailing);
+        } else {
+            const auto meaningful = BITS - leading - trailing;
+            writer.Write(0b11, 2);
+            writer.Write(leading, COUNT_BITS);
+            writer.Write(meaningful - 1, COUNT_BITS);
+            writer.Write(xorBits >> trailing, meaningful);
+            prevLeading = leading;
+            prevTrailing = trailing;
+        }
+    }
+}
+
+template<class T>
+auto Gorilla::Decode(const uint8_t *data, size_t bytes, size_t count, int64_t *times, T *values) -> bool {
+    constexpr unsigned BITS = sizeof(T) * 8;
+    constexpr unsigned COUNT_BITS = CountFieldBits(BITS);
+    if (count == 0) {
+        return true;
+    }
+    GorillaBitReader reader(data, bytes);
+    times[0] = static_cast<int64_t>(reader.Read(64));
+    auto prevBits = static_cast<GorillaBits<T>>(reader.Read(BITS));
+    values[0] = FromBits<T>(prevBits);
+
+    int64_t prevDelta = 0;
+    unsigned prevLeading = 0;
+    unsigned prevTrailing = 0;
+    for (size_t i = 1; i < count && !reader.Error(); ++i) {
+        int64_t deltaOfDelta = 0;
+        if (reader.Read(1) == 0b0) {
+            deltaOfDelta = 0;
+        } else if (reader.Read(1) == 0b0) {
+            deltaOfDelta = static_cast<int64_t>(reader.Read(7)) - 63;
+        } else if (reader.Read(1) == 0b0) {
+            deltaOfDelta = static_cast<int64_t>(reader.Read(9)) - 255;
+        } else if (reader.Read(1) == 0b0) {
+            deltaOfDelta = static_cast<int64_t>(reader.Read(12)) - 2047;
+        } else {
+            deltaOfDelta = static_cast<int64_t>(reader.Read(64));
+        }
+        prevDelta += deltaOfDelta;
+        times[i] = times[i - 1] + prevDelta;
+
+        if (reader.Read(1) == 0b1) {
+            if (reader.Read(1) == 0b1) {
+                prevLeading = static_cast<unsigned>(reader.Read(COUNT_BITS));
+                const auto meaningful = static_cast<unsigned>(reader.Read(COUNT_BITS)) + 1;
+                if (prevLeading + meaningful > BITS) {
+                    return false;
+                }
+                prevTrailing = BITS - prevLeading - meaningful;
+            }
+            const auto xorBits = reader.Read(BITS - prevLeading - prevTrailing) << prevTrailing;
+            prevBits = static_cast<GorillaBits<T>>(prevBits ^ xorBits);
+        }
+        values[i] = FromBits<T>(prevBits);
+    }
+    return !reader.Error();
+}
+
+template auto Gorilla::Encode(const int64_t *, const int16_t *, size_t, std::vector<uint8_t> &) -> void;
+template auto Gorilla::Encode(const int64_t *, const int32_t *, size_t, std::vector<uint8_t> &) -> void;
+template auto Gorilla::Encode(const int64_t *, const float *, size_t, std::vector<uint8_t> &) -> void;
+template auto Gorilla::Encode(const int64_t *, const double *, size_t, std::vector<uint8_t> &) -> void;
+template auto Gorilla::Decode(const uint8_t *, size_t, size_t, int64_t *, int16_t *) -> bool;
+template auto Gorilla::Decode(const uint8_t *, size_t, size_t, int64_t *, int32_t *) -> bool;
+template auto Gorilla::Decode(const uint8_t *, size_t, size_t, int64_t *, float *) -> bool;
+template auto Gorilla::Decode(const uint8_t *, size_t, size_t, int64_t *, double *) -> bool;
@@ -0,0 +1,31 @@
+#ifndef BUSPLOT_GORILLA_HPP
+#define BUSPLOT_GORILLA_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Compression of a chunk of samples in the style of Facebook's Gorilla time series database:
+ * timestamps are stored as the difference between consecutive deltas (delta-of-delta), mostly 1 bit for a
+ * regular sample rate, and values as the XOR with the previous value, mostly a few bits for slowly varying
+ * signals. The first sample is stored as is.
+ * The XOR works on the bit pattern of any value type, instantiated for int16, int32, float and double.
+ */
+class Gorilla {
+public:
+    /**
+     * Encode `count` samples, replacing the content of `out`.
+     */
+    template<class T>
+    static auto Encode(const int64_t *times, const T *values, size_t count, std::vector<uint8_t> &out) -> void;
+
+    /**
+     * Decode `count` samples encoded by Encode with the same value type.
+     * @return false if the data is truncated.
+     */
+    template<class T>
+    static auto Decode(const uint8_t *data, size_t bytes, size_t count, int64_t *times, T *values) -> bool;
+};
+
+#endif // BUSPLOT_GORILLA_HPP
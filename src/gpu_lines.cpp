@@ -0,0 +1,323 @@
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "gl.hpp"
+#include "gpu_lines.hpp"
+
+#include <implot_internal.h>
+
+static const char *VERTEX_SHADER = R"(#version 410 core
+layout(location = 0) in int aTime;
+layout(location = 1) in float aValue;
+uniform int uTimeStart;
+uniform float uTimeScale;
+uniform float uValueMin;
+uniform float uValueScale;
+void main() {
+    gl_Position = vec4(float(aTime - uTimeStart) * uTimeScale - 1.0, (aValue - uValueMin) * uValueScale - 1.0,
+                       0.0, 1.0);
+}
+)";
+
+// Widens every segment into a quad of the line weight, extended by half of it at both ends to close the joints.
+static const char *GEOMETRY_SHADER = R"(#version 410 core
+layout(lines) in;
+layout(triangle_strip, max_vertices = 4) out;
+uniform vec2 uViewportSize;
+uniform float uThickness;
+void main() {
+    vec2 a = gl_in[0].gl_Position.xy;
+    vec2 b = gl_in[1].gl_Position.xy;
+    vec2 direction = (b - a) * uViewportSize;
+    float pixels = length(direction);
+    vec2 along = pixels > 0.0 ? direction / pixels : vec2(1.0, 0.0);
+    vec2 across = vec2(-along.y, along.x) * uThickness / uViewportSize;
+    along *= uThickness / uViewportSize;
+    gl_Position = vec4(a - along + across, 0.0, 1.0);
+    EmitVertex();
+    gl_Position = vec4(a - along - across, 0.0, 1.0);
+    EmitVertex();
+    gl_Position = vec4(b + along + across, 0.0, 1.0);
+    EmitVertex();
+    gl_Position = vec4(b + along - across, 0.0, 1.0);
+    EmitVertex();
+    EndPrimitive();
+}
+)";
+
+static const char *FRAGMENT_SHADER = R"(#version 410 core
+uniform vec4 uColor;
+out vec4 fragColor;
+void main() {
+    fragColor = uColor;
+}
+)";
+
+/**
+ * @return 0 if the shader doesn't compile, the error is logged.
+ */
+static auto CompileShader(GLenum type, const char *source) -> GLuint {
+    const auto shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[1024] = {};
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        spdlog::error("GpuLineRenderer: shader compilation failed: {}", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+auto GpuLineRenderer::NewFrame() -> void {
+    m_Draws.clear();
+    for (auto it = m_Buffers.begin(); it != m_Buffers.end();) {
+        if (it->second.m_Frame != m_Frame) {
+            Free(it->second);
+            it = m_Buffers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    ++m_Frame;
+}
+
+template<class T>
+auto GpuLineRenderer::Plot(const char *label, const Series<T> &series, const TimeType &beginTime,
+                           const TimeType &endTime) -> bool {
+    if (m_ProgramFailed || (!m_Program && !BuildProgram())) {
+        return false;
+    }
+    const auto limits = ImPlot::GetPlotLimits();
+    const auto timeSpan = (limits.X.Max - limits.X.Min) * 1000000.;
+    if (timeSpan > static_cast<double>(MAX_TIME_OFFSET)) {
+        return false;
+    }
+    auto &buffer = m_Buffers[&series];
+    buffer.m_Frame = m_Frame;
+    Upload(buffer, series.Storage());
+
+    const auto plotStart = static_cast<Timestamp>(std::floor(limits.X.Min * 1000000.));
+    const auto timeStart = plotStart - buffer.m_Window.m_Origin;
+    if (std::abs(timeStart) > MAX_TIME_OFFSET || plotStart < buffer.m_Window.m_Horizon) {
+        return false;
+    }
+    if (!ImPlot::BeginItem(label, ImPlotCol_Line)) {
+        return true;
+    }
+    if (ImPlot::FitThisFrame()) {
+        const auto view = series.View(beginTime, endTime, FIT_RESOLUTION);
+        for (size_t i = 0; i < view.Size(); ++i) {
+            ImPlot::FitPoint(ImPlotPoint(static_cast<double>(view.TimeAt(i)) / 1000000.,
+                                         static_cast<double>(view.ValueAt(i))));
+        }
+    }
+    const auto count = buffer.m_Uploaded - buffer.m_First;
+    if (count >= 2 && timeSpan > 0 && limits.Y.Max > limits.Y.Min) {
+        const auto &item = ImPlot::GetItemData();
+        const auto startSlot = buffer.m_First % buffer.m_Slots;
+        const auto firstCount = std::min(count, buffer.m_Slots + 1 - startSlot);
+        const auto plotPos = ImPlot::GetPlotPos();
+        const auto plotSize = ImPlot::GetPlotSize();
+        m_Draws.push_back(Draw{
+                this,
+                buffer.m_VertexArray,
+                {static_cast<GLint>(startSlot), 0},
+                {static_cast<GLsizei>(firstCount),
+                 static_cast<GLsizei>(count > firstCount ? count - (buffer.m_Slots - startSlot) : 0)},
+                plotPos,
+                ImVec2(plotPos.x + plotSize.x, plotPos.y + plotSize.y),
+                static_cast<GLint>(timeStart),
+                static_cast<float>(2. / timeSpan),
+                static_cast<float>(limits.Y.Min),
+                static_cast<float>(2. / (limits.Y.Max - limits.Y.Min)),
+                item.Colors[ImPlotCol_Line],
+                item.LineWeight,
+        });
+        auto *drawList = ImPlot::GetPlotDrawList();
+        drawList->AddCallback(RunDraw, &m_Draws.back());
+        drawList->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+    }
+    ImPlot::EndItem();
+    return true;
+}
+
+template<class T>
+auto GpuLineRenderer::Upload(Buffer &buffer, const std::shared_ptr<const SeriesStorage<T>> &storage) -> void {
+    const auto committed = storage->Committed();
+    if (buffer.m_Storage != storage || buffer.m_Uploaded < storage->Oldest(committed)
+        || (committed > buffer.m_Uploaded && !buffer.m_Window.Fits(storage->TimeAt(committed - 1)))) {
+        // Start over from the window ending at the newest sample: the storage was replaced, the buffer fell behind,
+        // or the new timestamps are too far from the origin for 32 bits. Timestamps never decrease, so checking
+        // the newest one is enough, and a steady series only gets here once per MAX_TIME_OFFSET of its time.
+        if (buffer.m_Slots != storage->Capacity() || !buffer.m_VertexBuffer) {
+            Free(buffer);
+            Allocate(buffer, storage->Capacity());
+        }
+        buffer.m_Storage = storage;
+        buffer.m_Window = VertexWindow::Place(*storage, committed);
+        buffer.m_First = buffer.m_Window.m_First;
+        buffer.m_Uploaded = buffer.m_Window.m_First;
+    }
+    if (committed == buffer.m_Uploaded) {
+        return;
+    }
+
+    m_Staging.resize(committed - buffer.m_Uploaded);
+    for (auto seq = buffer.m_Uploaded; seq < committed; ++seq) {
+        m_Staging[seq - buffer.m_Uploaded] = Vertex{buffer.m_Window.VertexTime(storage->TimeAt(seq)),
+                                                    static_cast<float>(storage->ValueAt(seq))};
+    }
+    if (!storage->IsIntact(buffer.m_Uploaded)) {
+        // Overwritten while reading it, the next frame starts over from the oldest sample.
+        buffer.m_Storage.reset();
+        return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.m_VertexBuffer);
+    for (auto seq = buffer.m_Uploaded; seq < committed;) {
+        const auto slot = seq % buffer.m_Slots;
+        const auto count = std::min(committed - seq, buffer.m_Slots - slot);
+        const auto *vertices = &m_Staging[seq - buffer.m_Uploaded];
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(slot * sizeof(Vertex)),
+                        static_cast<GLsizeiptr>(count * sizeof(Vertex)), vertices);
+        if (slot == 0) {
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(buffer.m_Slots * sizeof(Vertex)),
+                            sizeof(Vertex), vertices);
+        }
+        seq += count;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    buffer.m_Uploaded = committed;
+    buffer.m_First = std::max(buffer.m_First, committed > buffer.m_Slots ? committed - buffer.m_Slots : 0);
+}
+
+auto GpuLineRenderer::Allocate(Buffer &buffer, uint64_t slots) -> void {
+    buffer.m_Slots = slots;
+    glGenVertexArrays(1, &buffer.m_VertexArray);
+    glGenBuffers(1, &buffer.m_VertexBuffer);
+    glBindVertexArray(buffer.m_VertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.m_VertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>((slots + 1) * sizeof(Vertex)), nullptr, GL_DYNAMIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribIPointer(0, 1, GL_INT, sizeof(Vertex), reinterpret_cast<const void *>(offsetof(Vertex, m_Time)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<const void *>(offsetof(Vertex, m_Value)));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+auto GpuLineRenderer::Free(Buffer &buffer) -> void {
+    if (buffer.m_VertexBuffer) {
+        glDeleteBuffers(1, &buffer.m_VertexBuffer);
+        glDeleteVertexArrays(1, &buffer.m_VertexArray);
+    }
+    buffer.m_VertexBuffer = 0;
+    buffer.m_VertexArray = 0;
+    buffer.m_Storage.reset();
+}
+
+auto GpuLineRenderer::Release() -> void {
+    for (auto &item : m_Buffers) {
+        Free(item.second);
+    }
+    m_Buffers.clear();
+    m_Draws.clear();
+    if (m_Program) {
+        glDeleteProgram(m_Program);
+        m_Program = 0;
+    }
+}
+
+auto GpuLineRenderer::BuildProgram() -> bool {
+    const GLuint shaders[] = {CompileShader(GL_VERTEX_SHADER, VERTEX_SHADER),
+                              CompileShader(GL_GEOMETRY_SHADER, GEOMETRY_SHADER),
+                              CompileShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER)};
+    const auto compiled = std::all_of(std::begin(shaders), std::end(shaders), [](GLuint shader) { return shader; });
+    GLint status = GL_FALSE;
+    if (compiled) {
+        m_Program = glCreateProgram();
+        for (const auto shader : shaders) {
+            glAttachShader(m_Program, shader);
+        }
+        glLinkProgram(m_Program);
+        glGetProgramiv(m_Program, GL_LINK_STATUS, &status);
+        if (status != GL_TRUE) {
+            char log[1024] = {};
+            glGetProgramInfoLog(m_Program, sizeof(log), nullptr, log);
+            spdlog::error("GpuLineRenderer: program link failed: {}", log);
+            glDeleteProgram(m_Program);
+            m_Program = 0;
+        }
+    }
+    for (const auto shader : shaders) {
+        if (shader) {
+            glDeleteShader(shader);
+        }
+    }
+    if (!m_Program) {
+        m_ProgramFailed = true;
+        return false;
+    }
+    m_TimeStartLocation = glGetUniformLocation(m_Program, "uTimeStart");
+    m_TimeScaleLocation = glGetUniformLocation(m_Program, "uTimeScale");
+    m_ValueMinLocation = glGetUniformLocation(m_Program, "uValueMin");
+    m_ValueScaleLocation = glGetUniformLocation(m_Program, "uValueScale");
+    m_ViewportSizeLocation = glGetUniformLocation(m_Program, "uViewportSize");
+    m_ThicknessLocation = glGetUniformLocation(m_Program, "uThickness");
+    m_ColorLocation = glGetUniformLocation(m_Program, "uColor");
+    return true;
+}
+
+auto GpuLineRenderer::RunDraw(const ImDrawList *, const ImDrawCmd *command) -> void {
+    const auto &draw = *static_cast<const Draw *>(command->UserCallbackData);
+    const auto &renderer = *draw.m_Renderer;
+    const auto *drawData = ImGui::GetDrawData();
+    const auto scale = drawData->FramebufferScale;
+    const auto framebufferHeight = drawData->DisplaySize.y * scale.y;
+    const auto toFramebuffer = [&](float x, float y) {
+        return ImVec2((x - drawData->DisplayPos.x) * scale.x, (y - drawData->DisplayPos.y) * scale.y);
+    };
+    const auto plotMin = toFramebuffer(draw.m_PlotMin.x, draw.m_PlotMin.y);
+    const auto plotMax = toFramebuffer(draw.m_PlotMax.x, draw.m_PlotMax.y);
+    const auto clipMin = toFramebuffer(command->ClipRect.x, command->ClipRect.y);
+    const auto clipMax = toFramebuffer(command->ClipRect.z, command->ClipRect.w);
+    if (clipMax.x <= clipMin.x || clipMax.y <= clipMin.y) {
+        return;
+    }
+    const auto viewportSize = ImVec2(plotMax.x - plotMin.x, plotMax.y - plotMin.y);
+    // OpenGL puts the framebuffer origin at the bottom left corner.
+    glViewport(static_cast<GLint>(plotMin.x), static_cast<GLint>(framebufferHeight - plotMax.y),
+               static_cast<GLsizei>(viewportSize.x), static_cast<GLsizei>(viewportSize.y));
+    glScissor(static_cast<GLint>(clipMin.x), static_cast<GLint>(framebufferHeight - clipMax.y),
+              static_cast<GLsizei>(clipMax.x - clipMin.x), static_cast<GLsizei>(clipMax.y - clipMin.y));
+    glUseProgram(renderer.m_Program);
+    glUniform1i(renderer.m_TimeStartLocation, draw.m_TimeStart);
+    glUniform1f(renderer.m_TimeScaleLocation, draw.m_TimeScale);
+    glUniform1f(renderer.m_ValueMinLocation, draw.m_ValueMin);
+    glUniform1f(renderer.m_ValueScaleLocation, draw.m_ValueScale);
+    glUniform2f(renderer.m_ViewportSizeLocation, viewportSize.x, viewportSize.y);
+    glUniform1f(renderer.m_ThicknessLocation, draw.m_Thickness * scale.x);
+    glUniform4f(renderer.m_ColorLocation, draw.m_Color.x, draw.m_Color.y, draw.m_Color.z, draw.m_Color.w);
+    glBindVertexArray(draw.m_VertexArray);
+    for (size_t i = 0; i < 2; ++i) {
+        if (draw.m_Counts[i] >= 2) {
+            glDrawArrays(GL_LINE_STRIP, draw.m_Firsts[i], draw.m_Counts[i]);
+        }
+    }
+}
+
+template auto GpuLineRenderer::Plot<int16_t>(const char *, const Series<int16_t> &, const TimeType &,
+                                             const TimeType &) -> bool;
+template auto GpuLineRenderer::Plot<int32_t>(const char *, const Series<int32_t> &, const TimeType &,
+                                             const TimeType &) -> bool;
+template auto GpuLineRenderer::Plot<float>(const char *, const Series<float> &, const TimeType &,
+                                           const TimeType &) -> bool;
+template auto GpuLineRenderer::Plot<double>(const char *, const Series<double> &, const TimeType &,
+                                            const TimeType &) -> bool;
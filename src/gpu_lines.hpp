@@ -0,0 +1,129 @@
+#ifndef BUSPLOT_GPU_LINES_HPP
+#define BUSPLOT_GPU_LINES_HPP
+
+#include <memory>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "gl.hpp"
+#include "series.hpp"
+#include "vertex_window.hpp"
+
+/**
+ * Line plot item drawn by the GPU from vertex buffers that persist across frames.
+ *
+ * The samples of each series are mirrored in a ring of vertices as large as its storage, so a frame only uploads
+ * the samples committed since the previous one. A vertex is a timestamp relative to the origin of its buffer, in
+ * 32-bit microseconds, and the value as a float. The vertex shader maps them to the plot, subtracting the start
+ * of the plot from the timestamp in integer arithmetic so that lines stay exact however far from the epoch they
+ * are, and a geometry shader widens every segment into a quad of the plot line weight. The CPU cost of a series
+ * is thus the same whatever number of samples is drawn.
+ *
+ * Only the samples of the storage within the VertexWindow of the buffer are drawn, archived history and samples
+ * too old for 32-bit timestamps are not. Every method must be called from the thread owning the OpenGL context,
+ * and Release before the context is destroyed.
+ */
+class GpuLineRenderer {
+public:
+    GpuLineRenderer() = default;
+
+    GpuLineRenderer(const GpuLineRenderer &) = delete;
+
+    auto operator=(const GpuLineRenderer &) -> GpuLineRenderer & = delete;
+
+    /**
+     * Start a frame: forget the draws of the previous one, and release the buffers of the series it didn't plot.
+     */
+    auto NewFrame() -> void;
+
+    /**
+     * Plot a series in the current plot, between ImPlot::BeginPlot and ImPlot::EndPlot. The plot limits are
+     * fitted to the samples in [beginTime, endTime] when it fits its axes this frame.
+     * @return false if the series must be plotted some other way: the shaders couldn't be built, or the plot
+     * spans more time than the 32-bit timestamps of the buffer cover, or starts before the oldest vertex while
+     * older samples were left out.
+     */
+    template<class T>
+    auto Plot(const char *label, const Series<T> &series, const TimeType &beginTime,
+              const TimeType &endTime) -> bool;
+
+    /**
+     * Delete every OpenGL object. The next Plot creates them again.
+     */
+    auto Release() -> void;
+
+private:
+    struct Vertex {
+        int32_t m_Time;
+        float m_Value;
+    };
+
+    /**
+     * Vertices of a series, in slot seq % m_Slots for sample seq. One more slot after the last one repeats the
+     * first slot, so that the line from the last slot to the first one is drawn by the first of two strips.
+     */
+    struct Buffer {
+        std::shared_ptr<const void> m_Storage;  ///< Storage the vertices come from
+        GLuint m_VertexArray = 0;
+        GLuint m_VertexBuffer = 0;
+        uint64_t m_Slots = 0;
+        uint64_t m_First = 0;                   ///< Sequence number of the oldest vertex
+        uint64_t m_Uploaded = 0;                ///< Sequence number of the next vertex to upload
+        VertexWindow m_Window;                  ///< Samples the vertices were placed for
+        int m_Frame = 0;                        ///< Last frame it was plotted
+    };
+
+    /**
+     * A series drawn by a callback of the plot draw list, when ImGui's OpenGL backend renders it.
+     */
+    struct Draw {
+        const GpuLineRenderer *m_Renderer;
+        GLuint m_VertexArray;
+        GLint m_Firsts[2];
+        GLsizei m_Counts[2];
+        ImVec2 m_PlotMin;       ///< Plot area in screen coordinates
+        ImVec2 m_PlotMax;
+        GLint m_TimeStart;      ///< Left edge of the plot relative to the buffer origin
+        float m_TimeScale;      ///< Clip space units per microsecond
+        float m_ValueMin;
+        float m_ValueScale;     ///< Clip space units per value unit
+        ImVec4 m_Color;
+        float m_Thickness;      ///< Line weight in screen pixels
+    };
+
+    /**
+     * Upload the samples committed since the last upload, or place the window again and upload all of its samples
+     * if the buffer doesn't follow this storage any more or the new samples don't fit the window.
+     */
+    template<class T>
+    auto Upload(Buffer &buffer, const std::shared_ptr<const SeriesStorage<T>> &storage) -> void;
+
+    auto Allocate(Buffer &buffer, uint64_t slots) -> void;
+
+    static auto Free(Buffer &buffer) -> void;
+
+    auto BuildProgram() -> bool;
+
+    static auto RunDraw(const ImDrawList *drawList, const ImDrawCmd *command) -> void;
+
+    static constexpr Timestamp MAX_TIME_OFFSET = VertexWindow::MAX_TIME_OFFSET;
+    static constexpr size_t FIT_RESOLUTION = 256; ///< Points of the view fitting the plot limits
+
+    GLuint m_Program = 0;
+    bool m_ProgramFailed = false;
+    GLint m_TimeStartLocation = -1;
+    GLint m_TimeScaleLocation = -1;
+    GLint m_ValueMinLocation = -1;
+    GLint m_ValueScaleLocation = -1;
+    GLint m_ViewportSizeLocation = -1;
+    GLint m_ThicknessLocation = -1;
+    GLint m_ColorLocation = -1;
+    std::unordered_map<const SeriesBase *, Buffer> m_Buffers;
+    std::deque<Draw> m_Draws;                   ///< Draws of this frame, which the draw list points to
+    std::vector<Vertex> m_Staging;
+    int m_Frame = 0;
+};
+
+#endif // BUSPLOT_GPU_LINES_HPP
@@ -1,10 +1,14 @@
 ﻿#include <cmrc/cmrc.hpp>
 #include <boost/asio/serial_port.hpp>
 
+#include <algorithm>
+#include <ctime>
+
 #include "gl.hpp"
 #include "chart.hpp"
 #include "rpc_protocol.hpp"
 #include "serial_rpc.hpp"
+#include "time_sync.hpp"
 #include "gui.hpp"
 
 CMRC_DECLARE(resources);
@@ -13,9 +17,10 @@ const char *Gui::STOP_BIT_ITEMS[3] = {u8"1", u8"1.5", u8"2"};
 const char *Gui::PARITY_ITEMS[3] = {u8"无校验", u8"奇校验", u8"偶校验"};
 const char *Gui::FLOW_CONTROL_ITEMS[3] = {u8"无", u8"软件", u8"硬件"};
 const char *Gui::PID_MODE_ITEMS[1] = {u8"位置式"};
+const char *Gui::DOWNSAMPLING_ITEMS[3] = {u8"关闭", u8"M4", u8"LTTB"};
 
-Gui::Gui(SerialRPC *rpc)
-        : m_SerialRPC(*rpc) {
+Gui::Gui(SerialRPC *rpc, TimeSync *timeSync)
+        : m_SerialRPC(*rpc), m_TimeSync(*timeSync) {
 }
 
 Gui::~Gui() {
@@ -46,6 +51,8 @@ auto Gui::Initialize() -> void {
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImPlot::CreateContext();
+    ImPlot::GetStyle().UseLocalTime = true; ///< Timestamps are UTC, the time axis shows them in local time
+    m_Chart.SetRedrawCallback([this] { NotifyData(); });
     ImGuiIO &io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
     io.IniFilename = nullptr;
@@ -75,16 +82,135 @@ auto Gui::Initialize() -> void {
 auto Gui::Run() -> void {
     Initialize();
     while (!glfwWindowShouldClose(m_Window)) {
+        WaitForFrame();
         Render();
     }
 }
 
+auto Gui::NotifyData() -> void {
+    if (m_Valid && !m_DataPending.exchange(true)) {
+        glfwPostEmptyEvent();
+    }
+}
+
+auto Gui::WaitForFrame() -> void {
+    using Seconds = std::chrono::duration<double>;
+    if (!m_OnDemandRedraw) {
+        glfwPollEvents(); ///< Redraw continuously, paced by the swap interval
+        return;
+    }
+    // Returns true if an event or NotifyData woke it up before the deadline.
+    const auto waitUntil = [this](std::chrono::steady_clock::time_point deadline) {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+        glfwWaitEventsTimeout(Seconds(deadline - now).count());
+        return std::chrono::steady_clock::now() < deadline;
+    };
+    const auto frameInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            Seconds(1. / std::max(m_MaxFps, 1)));
+    const auto earliest = m_LastFrame + frameInterval;
+    bool input = false;
+    while (std::chrono::steady_clock::now() < earliest) {
+        input = waitUntil(earliest) || input;
+    }
+    glfwPollEvents();
+    if (input && !m_DataPending) {
+        m_SettleFrames = INPUT_SETTLE_FRAMES;
+    }
+    if (m_SettleFrames > 0) {
+        --m_SettleFrames;
+        m_DataPending = false;
+        return;
+    }
+    const auto idleDeadline = m_LastFrame + IDLE_REFRESH_INTERVAL;
+    while (!glfwWindowShouldClose(m_Window)) {
+        if (glfwGetWindowAttrib(m_Window, GLFW_ICONIFIED)) {
+            glfwWaitEvents(); ///< Nothing is visible: pending data doesn't wake it up again until it is restored
+            continue;
+        }
+        if (m_DataPending.exchange(false)) {
+            break;
+        }
+        if (waitUntil(idleDeadline) && !m_DataPending) {
+            m_SettleFrames = INPUT_SETTLE_FRAMES - 1;
+        }
+        m_DataPending = false;
+        break;
+    }
+}
+
+auto Gui::ThreadCpuTime() -> std::chrono::microseconds {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    const auto ticks = (static_cast<uint64_t>(kernel.dwHighDateTime) << 32 | kernel.dwLowDateTime)
+                       + (static_cast<uint64_t>(user.dwHighDateTime) << 32 | user.dwLowDateTime);
+    return std::chrono::microseconds(ticks / 10); ///< 100 ns ticks
+#else
+    timespec time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return std::chrono::seconds(time.tv_sec)
+           + std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(time.tv_nsec));
+#endif // _WIN32
+}
+
+auto Gui::RenderFrameStats() -> void {
+    const ImGuiViewport *viewport = ImGui::GetMainViewport();
+    const auto margin = 10.f * m_ScaleFactor;
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - margin, viewport->WorkPos.y + margin),
+                            ImGuiCond_Always, ImVec2(1.f, 0.f));
+    ImGui::SetNextWindowViewport(viewport->ID);
+    ImGui::SetNextWindowBgAlpha(0.6f);
+    if (ImGui::Begin("##FrameStats", nullptr,
+                     ImGuiWindowFlags_NoDecoration
+                     | ImGuiWindowFlags_NoDocking
+                     | ImGuiWindowFlags_AlwaysAutoResize
+                     | ImGuiWindowFlags_NoSavedSettings
+                     | ImGuiWindowFlags_NoFocusOnAppearing
+                     | ImGuiWindowFlags_NoNav
+                     | ImGuiWindowFlags_NoInputs)) {
+        ImGui::Text(u8"CPU: %.2f ms/帧", m_FrameCpuMs);
+        ImGui::Text(u8"帧率: %.1f", m_FrameIntervalMs > 0 ? 1000. / m_FrameIntervalMs : 0.);
+        ImGui::End();
+    }
+}
+
+auto Gui::RenderTimeSync() -> void {
+    const auto stats = m_TimeSync.GetDeviceClock().Stats();
+    if (stats.m_RoundTrips == 0) {
+        ImGui::Text(u8"设备未响应对时请求");
+        return;
+    }
+    ImGui::Text(u8"往返次数: %llu", static_cast<unsigned long long>(stats.m_RoundTrips));
+    if (stats.m_Fitted) {
+        ImGui::Text(u8"时钟漂移: %.2f ppm, 偏差: ±%.1f us", stats.m_DriftPpm, stats.m_UncertaintyUs);
+    } else {
+        ImGui::Text(u8"时钟漂移: 估计中");
+    }
+    ImGui::Text(u8"往返延迟: 最小 %lld us, 中位数 %lld us", static_cast<long long>(stats.m_MinRoundTrip),
+                static_cast<long long>(stats.m_MedianRoundTrip));
+    ImGui::SameLine();
+    HelpMarker(u8"往返延迟分布, 每格 0.25 ms, 最后一格包含更长的往返\n"
+               u8"设备时钟按最快的往返对时, 偏差为其往返延迟的一半\n");
+
+    float histogram[DeviceClock::RTT_BINS];
+    std::copy(std::begin(stats.m_RoundTripHistogram), std::end(stats.m_RoundTripHistogram), histogram);
+    const auto range = std::chrono::duration<double, std::milli>(DeviceClock::RTT_BIN_WIDTH * DeviceClock::RTT_BINS);
+    const auto overlay = fmt::format("0 - {:g} ms", range.count());
+    ImGui::PlotHistogram("##RoundTrips", histogram, static_cast<int>(DeviceClock::RTT_BINS), 0, overlay.c_str(), 0.f,
+                         FLT_MAX, ImVec2(-1, 120.f * m_ScaleFactor));
+}
+
 auto Gui::Chart() noexcept -> class Chart & {
     return m_Chart;
 }
 
 auto Gui::CloseWindow() -> void {
+    m_Chart.SetRedrawCallback(nullptr);
     if (m_Window) {
+        m_Chart.ReleaseGpuResources();
         ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplGlfw_Shutdown();
         ImPlot::DestroyContext();
@@ -95,6 +221,15 @@ auto Gui::CloseWindow() -> void {
 }
 
 auto Gui::Render() -> void {
+    const auto frameStart = std::chrono::steady_clock::now();
+    const auto cpuStart = ThreadCpuTime();
+    constexpr double SMOOTHING = 0.1;
+    if (m_LastFrame != std::chrono::steady_clock::time_point{}) {
+        const auto interval = std::chrono::duration<double, std::milli>(frameStart - m_LastFrame).count();
+        m_FrameIntervalMs += (interval - m_FrameIntervalMs) * SMOOTHING;
+    }
+    m_LastFrame = frameStart;
+
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
@@ -138,6 +273,18 @@ auto Gui::Render() -> void {
         if (m_ConnectErrorTips.length() > 0) {
             ImGui::Text("%s", m_ConnectErrorTips.c_str());
         }
+        if (m_SerialRPC.IsValid()) {
+            const auto counters = m_SerialRPC.Counters();
+            ImGui::Text(u8"接收帧: %llu, 其中重新同步后找回: %llu", static_cast<unsigned long long>(counters.m_Frames),
+                        static_cast<unsigned long long>(counters.m_Recovered));
+            ImGui::Text(u8"丢弃: %llu, 跳过字节: %llu", static_cast<unsigned long long>(counters.m_Dropped),
+                        static_cast<unsigned long long>(counters.m_SkippedBytes));
+        }
+        ImGui::End();
+    }
+
+    if (ImGui::Begin(u8"时钟同步", nullptr)) {
+        RenderTimeSync();
         ImGui::End();
     }
 
@@ -179,9 +326,61 @@ auto Gui::Render() -> void {
         if (ImGui::DragFloat(u8"图表时长", &m_ChartTimeLimit, 10.f, 1000.f, 0.f, "%.3f ms")) {
             m_Chart.SetTimeLimit(std::chrono::microseconds(static_cast<long long>(m_ChartTimeLimit * 1000.f)));
         }
+        m_Frozen = m_Chart.IsFrozen();
+        if (ImGui::Checkbox(u8"冻结图表", &m_Frozen)) {
+            m_Chart.SetFrozen(m_Frozen);
+        }
+        ImGui::SameLine();
+        HelpMarker(u8"图表停止跟随最新数据, 可拖动和缩放查看历史, 数据继续在后台记录\n"
+                   u8"双击图表自动调整纵轴, 开启历史存盘后可查看超出缓冲容量的数据\n");
+        if (ImGui::InputInt(u8"缓冲容量", &m_SeriesCapacity, 1024, 65536, ImGuiInputTextFlags_EnterReturnsTrue)) {
+            m_SeriesCapacity = std::max(m_SeriesCapacity, 1);
+            m_Chart.SetSeriesCapacity(static_cast<size_t>(m_SeriesCapacity));
+        }
+        ImGui::SameLine();
+        HelpMarker(u8"每个信号保留的最大采样点数\n"
+                   u8"超出后最旧的采样点将被覆盖\n");
+        if (ImGui::Checkbox(u8"等间隔时基", &m_ImplicitTimebase)) {
+            m_Chart.SetSeriesTimebase(m_ImplicitTimebase ? Timebase::Implicit : Timebase::Explicit);
+        }
+        ImGui::SameLine();
+        HelpMarker(u8"按固定周期采样的信号只保存起始时间和采样周期, 不保存每个采样点的时间戳\n"
+                   u8"时间抖动过大的信号会自动恢复为逐点时间戳\n");
+        if (ImGui::Combo(u8"降采样", &m_Downsampling, DOWNSAMPLING_ITEMS,
+                         sizeof(DOWNSAMPLING_ITEMS) / sizeof(const char *))) {
+            m_Chart.SetDownsampling(static_cast<Downsampling>(m_Downsampling));
+        }
+        ImGui::SameLine();
+        HelpMarker(u8"绘制前按像素列减少采样点\n"
+                   u8"M4: 保留每列的首, 尾, 最小和最大点, 与绘制全部采样点的结果一致\n"
+                   u8"LTTB: 保留曲线形状, 每列一个点\n");
+        m_GpuLines = m_Chart.IsGpuLines();
+        if (ImGui::Checkbox(u8"GPU 绘制", &m_GpuLines)) {
+            m_Chart.SetGpuLines(m_GpuLines);
+        }
+        ImGui::SameLine();
+        HelpMarker(u8"曲线常驻显存, 每帧只上传新采样点, 由着色器绘制\n"
+                   u8"绘制开销与采样点数无关, 不进行降采样, 不显示存盘的历史数据\n");
+        m_Archiving = m_Chart.IsArchiving();
+        if (ImGui::Checkbox(u8"历史存盘", &m_Archiving)) {
+            m_Chart.SetArchiving(m_Archiving);
+        }
+        ImGui::SameLine();
+        HelpMarker(u8"将超出缓冲容量的历史数据写入临时目录下的内存映射文件\n"
+                   u8"用于长时间记录\n");
+        ImGui::Checkbox(u8"按需重绘", &m_OnDemandRedraw);
+        ImGui::SameLine();
+        HelpMarker(u8"仅在有输入或新数据时重绘, 其余时间休眠\n"
+                   u8"关闭后持续重绘\n");
+        ImGui::SliderInt(u8"最大帧率", &m_MaxFps, 1, 240);
+        ImGui::Checkbox(u8"显示帧耗时", &m_ShowFrameStats);
         ImGui::End();
     }
 
+    if (m_ShowFrameStats) {
+        RenderFrameStats();
+    }
+
     ImGui::Render();
 
     int width, height;
@@ -190,9 +389,10 @@ auto Gui::Render() -> void {
     glClear(GL_COLOR_BUFFER_BIT);
 
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    const auto cpu = std::chrono::duration<double, std::milli>(ThreadCpuTime() - cpuStart).count();
+    m_FrameCpuMs += (cpu - m_FrameCpuMs) * SMOOTHING;
 
     glfwSwapBuffers(m_Window);
-    glfwPollEvents();
 }
 
 void Gui::HelpMarker(const char *desc) {
@@ -2,9 +2,11 @@
 #define BUSPLOT_GUI_HPP
 
 #include <atomic>
+#include <chrono>
 
 #include "chart.hpp"
 #include "serial_rpc.hpp"
+#include "time_sync.hpp"
 
 #ifdef _WIN32
 #define NOMINMAX
@@ -13,7 +15,7 @@
 
 class Gui {
 public:
-    explicit Gui(SerialRPC *rpc);
+    Gui(SerialRPC *rpc, TimeSync *timeSync);
 
     ~Gui();
 
@@ -23,12 +25,37 @@ public:
 
     auto Chart() noexcept -> Chart &;
 
+    /**
+     * Request a redraw because new samples arrived. It may be called from any thread, and is cheap when a
+     * redraw is already pending.
+     */
+    auto NotifyData() -> void;
+
     auto CloseWindow() -> void;
 
 private:
 
     auto Render() -> void;
 
+    /**
+     * Process window events and return when the next frame is due: the frame rate cap has elapsed and there was
+     * input, new data, or nothing for IDLE_REFRESH_INTERVAL. Sleeps in glfwWaitEventsTimeout meanwhile, and
+     * until the window is restored while it is minimized.
+     */
+    auto WaitForFrame() -> void;
+
+    auto RenderFrameStats() -> void;
+
+    /**
+     * Drift, uncertainty and round trip latency histogram of the device clock synchronization.
+     */
+    auto RenderTimeSync() -> void;
+
+    /**
+     * CPU time consumed by the calling thread.
+     */
+    [[nodiscard]] static auto ThreadCpuTime() -> std::chrono::microseconds;
+
     static void HelpMarker(const char *desc);
 
     static void StyleColorsVisualStudio(ImGuiStyle *dst = nullptr);
@@ -43,6 +70,10 @@ private:
     static const char *PARITY_ITEMS[3];
     static const char *FLOW_CONTROL_ITEMS[3];
     static const char *PID_MODE_ITEMS[1];
+    static const char *DOWNSAMPLING_ITEMS[3];
+
+    static constexpr auto IDLE_REFRESH_INTERVAL = std::chrono::milliseconds(250); ///< Keeps the time axis moving
+    static constexpr int INPUT_SETTLE_FRAMES = 2; ///< Frames drawn after an input event, for hover states and popups
 
     class Chart m_Chart{};
 
@@ -59,9 +90,24 @@ private:
     float m_ControlMatrix[3][3] = {};
     float m_ScaleFactor = 0;
     float m_ChartTimeLimit = 5000.f;
+    int m_SeriesCapacity = static_cast<int>(SeriesBase::DEFAULT_CAPACITY);
+    bool m_Archiving = false;
+    bool m_Frozen = false;
+    bool m_ImplicitTimebase = false;
+    int m_Downsampling = static_cast<int>(Downsampling::M4);
+    bool m_GpuLines = false;
+    bool m_OnDemandRedraw = true;
+    int m_MaxFps = 60;
+    bool m_ShowFrameStats = false;
+    std::atomic<bool> m_DataPending{false};
+    int m_SettleFrames = 0;
+    std::chrono::steady_clock::time_point m_LastFrame{};
+    double m_FrameCpuMs = 0;      ///< Smoothed CPU time spent building and submitting a frame
+    double m_FrameIntervalMs = 0; ///< Smoothed time between frames
     std::string m_ConnectErrorTips;
     std::atomic<bool> m_Valid = false;
     SerialRPC &m_SerialRPC;
+    TimeSync &m_TimeSync;
 };
 
 #endif // BUSPLOT_GUI_HPP
\ No newline at end of file
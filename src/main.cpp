@@ -4,6 +4,7 @@
 #include <chrono>
 
 #include "serial_rpc.hpp"
+#include "time_sync.hpp"
 #include "gui.hpp"
 
 #ifdef _WIN32
@@ -13,22 +14,86 @@
 #endif // _WIN32
 
 static SerialRPC serialRPC;
-static Gui gui(&serialRPC);
+static TimeSync timeSync(&serialRPC);
+static Gui gui(&serialRPC, &timeSync);
 
 auto HandleVariableAliasRequest(const VariableAliasReq &req) -> void {
     auto series = gui.Chart().GetOrAddSeries(req.m_VariableId);
     series->SetLabel(std::string(reinterpret_cast<const char *>(req.m_Alias)));
+    gui.NotifyData();
 }
 
-auto HandleUpdateVariableRequest(const UpdateVariableReq &req) -> void {
-    auto series = gui.Chart().GetOrAddSeries(req.m_VariableId);
-    auto t = std::chrono::time_point_cast<Duration>(Clock::now());
-    auto s = static_cast<double>(t.time_since_epoch().count()) / 1000000.f;
-    series->AddData(Dot{s, req.m_Value});
+template<class ReqType>
+auto HandleUpdateVariableRequest(const ReqType &req) -> void {
+    using ValueType = decltype(req.m_Value);
+    auto series = gui.Chart().GetOrAddSeries<ValueType>(req.m_VariableId);
+    series->AddData(std::chrono::time_point_cast<Duration>(Clock::now()), req.m_Value);
+    gui.NotifyData();
+}
+
+/**
+ * All the samples of a batch are added before a single redraw is requested.
+ */
+auto HandleUpdateVariablesRequest(const UpdateVariablesReq &req) -> void {
+    const auto time = std::chrono::time_point_cast<Duration>(Clock::now());
+    for (size_t i = 0; i < req.m_Count; ++i) {
+        const auto &sample = req.m_Samples[i];
+        gui.Chart().GetOrAddSeries<float>(sample.m_VariableId)->AddData(time, sample.m_Value);
+    }
+    gui.NotifyData();
+}
+
+/**
+ * The last sample of the batch is taken as received now, the previous ones one period apart before it. A batch
+ * received early enough to overlap the previous one is moved after it by Series::AddData.
+ */
+auto HandleUpdateVariableSamplesRequest(const UpdateVariableSamplesReq &req) -> void {
+    const auto period = Duration(req.m_Period);
+    const auto last = std::chrono::time_point_cast<Duration>(Clock::now());
+    auto series = gui.Chart().GetOrAddSeries<float>(req.m_VariableId);
+    series->AddData(last - period * (req.m_Count - 1), period, req.m_Values, req.m_Count);
+    gui.NotifyData();
+}
+
+auto HandleDeviceClockRequest(const DeviceClockReq &req) -> void {
+    spdlog::info("Device clock: {} ticks per second", req.m_Frequency);
+    timeSync.HandleDeviceClock(req);
+}
+
+auto HandleTimeSyncEchoRequest(const TimeSyncEchoReq &req) -> void {
+    timeSync.HandleEcho(req);
+}
+
+/**
+ * Samples carrying a device tick are stamped with its host time, whenever the frame was received.
+ */
+auto HandleUpdateVariablesTickedRequest(const UpdateVariablesTickedReq &req) -> void {
+    auto &deviceClock = timeSync.GetDeviceClock();
+    deviceClock.Observe(req.m_Tick, std::chrono::time_point_cast<Duration>(Clock::now()));
+    const auto time = deviceClock.ToHostTime(req.m_Tick);
+    for (size_t i = 0; i < req.m_Count; ++i) {
+        const auto &sample = req.m_Samples[i];
+        gui.Chart().GetOrAddSeries<float>(sample.m_VariableId)->AddData(time, sample.m_Value);
+    }
+    gui.NotifyData();
+}
+
+/**
+ * The samples of the batch are spread evenly between the host times of its first and last ticks.
+ */
+auto HandleUpdateVariableTickedSamplesRequest(const UpdateVariableTickedSamplesReq &req) -> void {
+    const auto lastTick = req.m_Tick + req.m_Period * (req.m_Count - 1u);
+    auto &deviceClock = timeSync.GetDeviceClock();
+    deviceClock.Observe(lastTick, std::chrono::time_point_cast<Duration>(Clock::now()));
+    const auto first = deviceClock.ToHostTime(req.m_Tick);
+    const auto period = req.m_Count > 1 ? (deviceClock.ToHostTime(lastTick) - first) / (req.m_Count - 1) : Duration(0);
+    gui.Chart().GetOrAddSeries<float>(req.m_VariableId)->AddData(first, period, req.m_Values, req.m_Count);
+    gui.NotifyData();
 }
 
 auto HandleRemoveVariableRequest(const RemoveVariableReq &req) -> void {
     gui.Chart().RemoveSeries(req.m_VariableId);
+    gui.NotifyData();
 }
 
 
@@ -36,7 +101,16 @@ int main() {
     spdlog::set_level(spdlog::level::info);
 
     serialRPC.RegisterMessage<VariableAliasReq>(HandleVariableAliasRequest);
-    serialRPC.RegisterMessage<UpdateVariableReq>(HandleUpdateVariableRequest);
+    serialRPC.RegisterMessage<UpdateVariableReq>(HandleUpdateVariableRequest<UpdateVariableReq>);
+    serialRPC.RegisterMessage<UpdateVariableInt16Req>(HandleUpdateVariableRequest<UpdateVariableInt16Req>);
+    serialRPC.RegisterMessage<UpdateVariableInt32Req>(HandleUpdateVariableRequest<UpdateVariableInt32Req>);
+    serialRPC.RegisterMessage<UpdateVariableDoubleReq>(HandleUpdateVariableRequest<UpdateVariableDoubleReq>);
+    serialRPC.RegisterMessage<UpdateVariablesReq>(HandleUpdateVariablesRequest);
+    serialRPC.RegisterMessage<UpdateVariableSamplesReq>(HandleUpdateVariableSamplesRequest);
+    serialRPC.RegisterMessage<DeviceClockReq>(HandleDeviceClockRequest);
+    serialRPC.RegisterMessage<TimeSyncEchoReq>(HandleTimeSyncEchoRequest);
+    serialRPC.RegisterMessage<UpdateVariablesTickedReq>(HandleUpdateVariablesTickedRequest);
+    serialRPC.RegisterMessage<UpdateVariableTickedSamplesReq>(HandleUpdateVariableTickedSamplesRequest);
     serialRPC.RegisterMessage<RemoveVariableReq>(HandleRemoveVariableRequest);
 
     gui.Run();
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <unordered_set>
+
+#include "plot_preparer.hpp"
+
+/**
+ * Read the points of a view into `points`, reduced to the pixel columns of the plot like the request asks.
+ */
+template<class T>
+static auto PreparePoints(const SeriesView<T> &view, const PlotPreparer::Request &request,
+                          std::vector<SamplePoint> &points) -> void {
+    const auto getPoint = [&](size_t point) {
+        return SamplePoint{static_cast<double>(view.TimeAt(point)) / 1000000.,
+                           static_cast<double>(view.ValueAt(point))};
+    };
+    if (request.m_Downsampling == Downsampling::M4 && view.Size() > 4 * request.m_Columns) {
+        const auto xMin = static_cast<double>(request.m_BeginTime.time_since_epoch().count()) / 1000000.;
+        const auto xMax = static_cast<double>(request.m_EndTime.time_since_epoch().count()) / 1000000.;
+        DownsampleM4(view.Size(), getPoint, xMin, xMax, request.m_Columns, points);
+    } else if (request.m_Downsampling == Downsampling::LTTB && view.Size() > request.m_Columns) {
+        DownsampleLTTB(view.Size(), getPoint, request.m_Columns, points);
+    } else {
+        // Uniform spans are copied without computing the timestamp of each of their samples.
+        points.resize(view.Size());
+        size_t next = 0;
+        for (const auto &span : view.UniformSpans()) {
+            for (; next < span.m_FirstPoint; ++next) {
+                points[next] = getPoint(next);
+            }
+            for (size_t i = 0; i < span.m_Count; ++i, ++next) {
+                const auto time = span.m_Start + static_cast<Timestamp>(i) * span.m_Period;
+                points[next] = SamplePoint{static_cast<double>(time) / 1000000., static_cast<double>(span.m_Values[i])};
+            }
+        }
+        for (; next < view.Size(); ++next) {
+            points[next] = getPoint(next);
+        }
+    }
+}
+
+PlotPreparer::PlotPreparer(size_t threadCount) {
+    for (size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i) {
+        m_Threads.emplace_back(&PlotPreparer::WorkerLoop, this);
+    }
+}
+
+PlotPreparer::~PlotPreparer() {
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_Condition.notify_all();
+    for (auto &thread : m_Threads) {
+        thread.join();
+    }
+}
+
+auto PlotPreparer::DefaultThreadCount() -> size_t {
+    return std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, MAX_THREADS);
+}
+
+auto PlotPreparer::Submit(std::shared_ptr<const SeriesRegistry::Snapshot> snapshot, const Request &request) -> void {
+    auto job = std::make_shared<Job>();
+    job->m_Snapshot = std::move(snapshot);
+    job->m_Request = request;
+    {
+        std::lock_guard lock(m_Mutex);
+        if (m_SlotsSnapshot != job->m_Snapshot) {
+            // Series were added or removed, drop the slots of the removed ones.
+            std::unordered_set<const SeriesBase *> present;
+            for (const auto &entry : *job->m_Snapshot) {
+                present.insert(entry.m_Series.get());
+            }
+            for (auto it = m_Slots.begin(); it != m_Slots.end();) {
+                it = present.count(it->first) ? std::next(it) : m_Slots.erase(it);
+            }
+            m_SlotsSnapshot = job->m_Snapshot;
+        }
+        if (m_Job && m_Job->m_Snapshot == job->m_Snapshot) {
+            const auto size = job->m_Snapshot->size();
+            if (size > 0 && m_Job->m_Done < size) {
+                job->m_First = (m_Job->m_First + std::min(m_Job->m_Next.load(), size)) % size;
+            }
+        }
+        m_Job = job;
+        m_CurrentJob = job.get();
+    }
+    m_Condition.notify_all();
+}
+
+auto PlotPreparer::Acquire(const SeriesBase *series) -> const std::vector<SamplePoint> & {
+    static const std::vector<SamplePoint> NO_POINTS;
+    std::shared_ptr<Slot> slot;
+    {
+        std::lock_guard lock(m_Mutex);
+        const auto it = m_Slots.find(series);
+        if (it == m_Slots.end()) {
+            return NO_POINTS;
+        }
+        slot = it->second;
+    }
+    {
+        std::lock_guard lock(slot->m_Mutex);
+        if (slot->m_Fresh) {
+            slot->m_Front.swap(slot->m_Ready);
+            slot->m_Fresh = false;
+        }
+    }
+    // The slot stays in m_Slots, which keeps the points alive, until the next Submit.
+    return slot->m_Front;
+}
+
+auto PlotPreparer::SetReadyCallback(std::function<void()> callback) -> void {
+    std::lock_guard lock(m_CallbackMutex);
+    m_ReadyCallback = std::move(callback);
+}
+
+auto PlotPreparer::WorkerLoop() -> void {
+    std::shared_ptr<Job> job;
+    while (true) {
+        {
+            std::unique_lock lock(m_Mutex);
+            m_Condition.wait(lock, [&] { return m_Stopping || m_Job != job; });
+            if (m_Stopping) {
+                return;
+            }
+            job = m_Job;
+        }
+        const auto &snapshot = *job->m_Snapshot;
+        for (auto i = job->m_Next++; i < snapshot.size() && m_CurrentJob == job.get(); i = job->m_Next++) {
+            Prepare(*job, snapshot[(job->m_First + i) % snapshot.size()]);
+            if (++job->m_Done == snapshot.size()) {
+                Complete(*job);
+            }
+        }
+    }
+}
+
+auto PlotPreparer::Prepare(Job &job, const SeriesRegistry::Entry &entry) -> void {
+    const auto slot = SlotOf(job, entry.m_Series);
+    if (!slot) {
+        return;
+    }
+    {
+        std::lock_guard writerLock(slot->m_WriterMutex);
+        const auto &request = job.m_Request;
+        bool intact = false;
+        for (int attempt = 0; attempt < MAX_READ_ATTEMPTS && !intact; ++attempt) {
+            VisitSeries(*entry.m_Series, [&](const auto &typed) {
+                const auto view = typed.View(request.m_BeginTime, request.m_EndTime, request.m_Resolution);
+                PreparePoints(view, request, slot->m_Back);
+                intact = view.IsIntact();
+            });
+        }
+        if (intact) {
+            std::lock_guard lock(slot->m_Mutex);
+            slot->m_Back.swap(slot->m_Ready);
+            slot->m_Fresh = true;
+        }
+    }
+    job.m_Samples += entry.m_Series->Stats().m_Count;
+}
+
+auto PlotPreparer::Complete(const Job &job) -> void {
+    const auto &request = job.m_Request;
+    const Signature signature{job.m_Snapshot.get(), job.m_Samples, request.m_Columns, request.m_Downsampling,
+                              request.m_EndTime - request.m_BeginTime,
+                              request.m_Following ? TimeType() : request.m_BeginTime};
+    {
+        std::lock_guard lock(m_Mutex);
+        if (signature == m_Signature) {
+            return;
+        }
+        m_Signature = signature;
+    }
+    std::lock_guard lock(m_CallbackMutex);
+    if (m_ReadyCallback) {
+        m_ReadyCallback();
+    }
+}
+
+auto PlotPreparer::SlotOf(const Job &job, const std::shared_ptr<SeriesBase> &series) -> std::shared_ptr<Slot> {
+    std::lock_guard lock(m_Mutex);
+    if (job.m_Snapshot != m_SlotsSnapshot) {
+        return nullptr;
+    }
+    auto &slot = m_Slots[series.get()];
+    if (!slot) {
+        slot = std::make_shared<Slot>();
+        slot->m_Series = series;
+    }
+    return slot;
+}
+
+auto PlotPreparer::Signature::operator==(const Signature &other) const noexcept -> bool {
+    return m_Snapshot == other.m_Snapshot && m_Samples == other.m_Samples && m_Columns == other.m_Columns
+           && m_Downsampling == other.m_Downsampling && m_Span == other.m_Span && m_BeginTime == other.m_BeginTime;
+}
@@ -0,0 +1,136 @@
+#ifndef BUSPLOT_PLOT_PREPARER_HPP
+#define BUSPLOT_PLOT_PREPARER_HPP
+
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+#include <atomic>
+#include <cstdint>
+
+#include "series.hpp"
+#include "series_registry.hpp"
+#include "downsample.hpp"
+
+/**
+ * Prepares the points of the plot on worker threads, so that the GUI thread only submits them.
+ *
+ * Every frame the GUI thread submits a request for a registry snapshot. Workers take its series one at a time,
+ * look the time range up, read and downsample the points, and hand the result over per series: a worker fills
+ * the back buffer of the series, then swaps it with the ready one, which the GUI thread swaps into the front one
+ * it plots from. Neither side ever waits for the other to be done with a buffer, and the buffers are reused from
+ * frame to frame. The GUI thread thus plots the points of a previous request, usually that of the previous frame.
+ *
+ * A new request supersedes the one being prepared: workers move to it as soon as they finish their current series.
+ * It starts with the series the superseded request didn't get to, so that every series is eventually prepared even
+ * when preparing all of them takes longer than a frame.
+ *
+ * Points overwritten by the writer while being read are read again, up to MAX_READ_ATTEMPTS times, then the series
+ * keeps its previous points rather than publishing torn ones.
+ */
+class PlotPreparer {
+public:
+    struct Request {
+        TimeType m_BeginTime;
+        TimeType m_EndTime;
+        size_t m_Columns;               ///< Pixel width of the plot
+        size_t m_Resolution;            ///< Resolution of the views, see Series::View
+        Downsampling m_Downsampling;
+        bool m_Following = true;        ///< The range follows the newest samples, see SetReadyCallback
+    };
+
+    explicit PlotPreparer(size_t threadCount = DefaultThreadCount());
+
+    ~PlotPreparer();
+
+    PlotPreparer(const PlotPreparer &) = delete;
+
+    auto operator=(const PlotPreparer &) -> PlotPreparer & = delete;
+
+    /**
+     * Prepare every series of a snapshot for a request. Only called from the GUI thread.
+     */
+    auto Submit(std::shared_ptr<const SeriesRegistry::Snapshot> snapshot, const Request &request) -> void;
+
+    /**
+     * Latest points prepared for a series, none until a request was prepared for it. Only called from the GUI
+     * thread, the points are valid until the next Submit.
+     */
+    [[nodiscard]] auto Acquire(const SeriesBase *series) -> const std::vector<SamplePoint> &;
+
+    /**
+     * Set the function called from a worker thread when a request was prepared for every series, if the series
+     * got new samples or the request changed size since the previous one. It isn't called for a range following
+     * the newest samples merely moving forward, so that drawing the prepared points doesn't request another frame
+     * forever, but is when any other range moves.
+     * Once this returns, the previous function is not running and won't be called again.
+     */
+    auto SetReadyCallback(std::function<void()> callback) -> void;
+
+    [[nodiscard]] static auto DefaultThreadCount() -> size_t;
+
+private:
+    static constexpr size_t MAX_THREADS = 4;
+    static constexpr int MAX_READ_ATTEMPTS = 3;
+
+    struct Job {
+        std::shared_ptr<const SeriesRegistry::Snapshot> m_Snapshot;
+        Request m_Request;
+        size_t m_First = 0;                 ///< Series prepared first, the others follow it round the snapshot
+        std::atomic<size_t> m_Next{0};      ///< Next series to prepare, counting from m_First
+        std::atomic<size_t> m_Done{0};      ///< Series prepared
+        std::atomic<uint64_t> m_Samples{0}; ///< Samples added to the prepared series so far
+    };
+
+    /**
+     * What the prepared points depend on, apart from the time range.
+     */
+    struct Signature {
+        const SeriesRegistry::Snapshot *m_Snapshot = nullptr;
+        uint64_t m_Samples = 0;
+        size_t m_Columns = 0;
+        Downsampling m_Downsampling = Downsampling::Off;
+        Duration m_Span{};
+        TimeType m_BeginTime{};         ///< Only for ranges not following the newest samples
+
+        [[nodiscard]] auto operator==(const Signature &other) const noexcept -> bool;
+    };
+
+    struct Slot {
+        std::shared_ptr<const SeriesBase> m_Series; ///< Keeps the key of the slot from being reused
+        std::mutex m_WriterMutex;                   ///< Held by the worker filling m_Back
+        std::vector<SamplePoint> m_Back;
+        std::mutex m_Mutex;                         ///< Guards m_Ready and m_Fresh
+        std::vector<SamplePoint> m_Ready;
+        bool m_Fresh = false;
+        std::vector<SamplePoint> m_Front;           ///< Only touched by the GUI thread
+    };
+
+    auto WorkerLoop() -> void;
+
+    auto Prepare(Job &job, const SeriesRegistry::Entry &entry) -> void;
+
+    auto Complete(const Job &job) -> void;
+
+    /**
+     * Slot of a series of a job, nullptr if the job is for a snapshot older than the slots.
+     */
+    [[nodiscard]] auto SlotOf(const Job &job, const std::shared_ptr<SeriesBase> &series) -> std::shared_ptr<Slot>;
+
+    std::mutex m_Mutex;                 ///< Guards m_Job, m_Stopping, m_Slots and m_Signature
+    std::condition_variable m_Condition;
+    std::shared_ptr<Job> m_Job;
+    std::atomic<const Job *> m_CurrentJob{nullptr};
+    bool m_Stopping = false;
+    std::unordered_map<const SeriesBase *, std::shared_ptr<Slot>> m_Slots;
+    std::shared_ptr<const SeriesRegistry::Snapshot> m_SlotsSnapshot; ///< Snapshot m_Slots was last pruned for
+    Signature m_Signature;              ///< Of the last request prepared for every series
+    std::mutex m_CallbackMutex;
+    std::function<void()> m_ReadyCallback;
+    std::vector<std::thread> m_Threads;
+};
+
+#endif // BUSPLOT_PLOT_PREPARER_HPP
@@ -0,0 +1,106 @@
+#include <algorithm>
+
+#include "pyramid.hpp"
+
+template<class T>
+MinMaxPyramid<T>::Level::Level(size_t capacity, size_t slots)
+        : m_Capacity(capacity), m_Times(slots), m_Min(slots), m_Max(slots) {}
+
+template<class T>
+MinMaxPyramid<T>::MinMaxPyramid(size_t capacity, size_t slack) {
+    for (size_t level = 1; level <= MAX_LEVELS && BucketSize(level) <= capacity; ++level) {
+        const auto bucketCapacity = capacity / BucketSize(level) + 1;
+        const auto bucketSlack = slack / BucketSize(level) + 1;
+        m_Levels.push_back(std::make_unique<Level>(bucketCapacity, bucketCapacity + bucketSlack));
+    }
+}
+
+template<class T>
+auto MinMaxPyramid<T>::Reserve() -> void {
+    // The next sample finishes the open bucket of each level up to the first one that still lacks more entries.
+    for (const auto &level : m_Levels) {
+        if (level->m_OpenCount + 1 < FANOUT) {
+            break;
+        }
+        const auto index = level->m_Committed.load(std::memory_order_relaxed);
+        level->m_Times.Reserve(index);
+        level->m_Min.Reserve(index);
+        level->m_Max.Reserve(index);
+    }
+}
+
+template<class T>
+auto MinMaxPyramid<T>::Push(int64_t time, T value) noexcept -> void {
+    if (!m_Levels.empty()) {
+        Accumulate(1, time, value, value);
+    }
+}
+
+template<class T>
+auto MinMaxPyramid<T>::Levels() const noexcept -> size_t {
+    return m_Levels.size();
+}
+
+template<class T>
+auto MinMaxPyramid<T>::Committed(size_t level) const noexcept -> uint64_t {
+    return m_Levels[level - 1]->m_Committed.load(std::memory_order_acquire);
+}
+
+template<class T>
+auto MinMaxPyramid<T>::Oldest(size_t level, uint64_t committed) const noexcept -> uint64_t {
+    const auto capacity = m_Levels[level - 1]->m_Capacity;
+    return committed > capacity ? committed - capacity : 0;
+}
+
+template<class T>
+auto MinMaxPyramid<T>::IsIntact(size_t level, uint64_t index) const noexcept -> bool {
+    const auto &l = *m_Levels[level - 1];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return l.m_Committed.load(std::memory_order_relaxed) < index + l.m_Times.Slots();
+}
+
+template<class T>
+auto MinMaxPyramid<T>::TimeAt(size_t level, uint64_t index) const noexcept -> int64_t {
+    return m_Levels[level - 1]->m_Times.Load(index);
+}
+
+template<class T>
+auto MinMaxPyramid<T>::MinAt(size_t level, uint64_t index) const noexcept -> T {
+    return m_Levels[level - 1]->m_Min.Load(index);
+}
+
+template<class T>
+auto MinMaxPyramid<T>::MaxAt(size_t level, uint64_t index) const noexcept -> T {
+    return m_Levels[level - 1]->m_Max.Load(index);
+}
+
+template<class T>
+auto MinMaxPyramid<T>::Accumulate(size_t level, int64_t time, T min, T max) noexcept -> void {
+    auto &l = *m_Levels[level - 1];
+    if (l.m_OpenCount == 0) {
+        l.m_OpenTime = time;
+        l.m_OpenMin = min;
+        l.m_OpenMax = max;
+    } else {
+        l.m_OpenMin = std::min(l.m_OpenMin, min);
+        l.m_OpenMax = std::max(l.m_OpenMax, max);
+    }
+    if (++l.m_OpenCount < FANOUT) {
+        return;
+    }
+    l.m_OpenCount = 0;
+    const auto index = l.m_Committed.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    l.m_Times.Store(index, l.m_OpenTime);
+    l.m_Min.Store(index, l.m_OpenMin);
+    l.m_Max.Store(index, l.m_OpenMax);
+    l.m_Committed.store(index + 1, std::memory_order_release);
+    if (level < m_Levels.size()) {
+        Accumulate(level + 1, l.m_OpenTime, l.m_OpenMin, l.m_OpenMax);
+    }
+}
+
+template class MinMaxPyramid<int16_t>;
+template class MinMaxPyramid<int32_t>;
+template class MinMaxPyramid<float>;
+template class MinMaxPyramid<double>;
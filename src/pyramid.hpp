@@ -0,0 +1,90 @@
+#ifndef BUSPLOT_PYRAMID_HPP
+#define BUSPLOT_PYRAMID_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "ring_buffer.hpp"
+
+/**
+ * Multi-resolution min/max summary of a sample stream, updated incrementally as samples arrive.
+ *
+ * Level `k` (starting at 1, level 0 being the raw samples) stores one bucket per FANOUT^k consecutive samples,
+ * with the timestamp of its first sample and the minimum and maximum of its values. Bucket `n` of level `k`
+ * covers exactly the samples [n * FANOUT^k, (n + 1) * FANOUT^k), so levels line up with each other.
+ *
+ * Like SeriesStorage it is written by a single producer and read without locking. A finished bucket is
+ * published on its level before it's accumulated into the coarser one, so a reader that snapshots the
+ * committed counts from the coarsest level down always finds the finer levels covering at least as much.
+ * Extrema are kept in the value type of the series, T.
+ */
+template<class T>
+class MinMaxPyramid {
+public:
+    static constexpr size_t FANOUT = 4;
+    static constexpr size_t MAX_LEVELS = 12;
+
+    /**
+     * @param capacity Number of samples the pyramid should summarize.
+     * @param slack Extra samples the producer may push before overwriting what a reader may still look at.
+     */
+    MinMaxPyramid(size_t capacity, size_t slack);
+
+    /**
+     * Allocate every slot the next Push may store to, see RingBuffer::Reserve.
+     * @throw std::bad_alloc if a slot can't be allocated.
+     */
+    auto Reserve() -> void;
+
+    /**
+     * Summarize a sample, after Reserve.
+     */
+    auto Push(int64_t time, T value) noexcept -> void;
+
+    /**
+     * Number of bucket levels, level indices are in [1, Levels()].
+     */
+    [[nodiscard]] auto Levels() const noexcept -> size_t;
+
+    [[nodiscard]] static constexpr auto BucketSize(size_t level) noexcept -> uint64_t {
+        return level == 0 ? 1 : FANOUT * BucketSize(level - 1);
+    }
+
+    [[nodiscard]] auto Committed(size_t level) const noexcept -> uint64_t;
+
+    [[nodiscard]] auto Oldest(size_t level, uint64_t committed) const noexcept -> uint64_t;
+
+    [[nodiscard]] auto IsIntact(size_t level, uint64_t index) const noexcept -> bool;
+
+    [[nodiscard]] auto TimeAt(size_t level, uint64_t index) const noexcept -> int64_t;
+
+    [[nodiscard]] auto MinAt(size_t level, uint64_t index) const noexcept -> T;
+
+    [[nodiscard]] auto MaxAt(size_t level, uint64_t index) const noexcept -> T;
+
+private:
+    struct Level {
+        Level(size_t capacity, size_t slots);
+
+        size_t m_Capacity;
+        RingBuffer<int64_t> m_Times;
+        RingBuffer<T> m_Min;
+        RingBuffer<T> m_Max;
+        std::atomic<uint64_t> m_Committed{0};
+
+        // The bucket being accumulated, only touched by the producer.
+        int64_t m_OpenTime{};
+        T m_OpenMin{};
+        T m_OpenMax{};
+        size_t m_OpenCount{};
+    };
+
+    auto Accumulate(size_t level, int64_t time, T min, T max) noexcept -> void;
+
+    std::vector<std::unique_ptr<Level>> m_Levels;
+};
+
+#endif // BUSPLOT_PYRAMID_HPP
@@ -0,0 +1,100 @@
+#ifndef BUSPLOT_RING_BUFFER_HPP
+#define BUSPLOT_RING_BUFFER_HPP
+
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Fixed-size circular storage written by a single producer and read by any number of readers without locking.
+ * Elements are addressed by sequence number (the count of elements stored before them), the slot of `seq` is
+ * reused by `seq + Slots()`.
+ *
+ * The slots are allocated in chunks of CHUNK_SLOTS as the producer first reaches them, so that a buffer sized for
+ * many elements costs little until they arrive. The producer reserves a slot before storing to it, which is the
+ * only step that may allocate or throw: it can reserve every slot a change needs before making any of it, and
+ * once every chunk is allocated, reserving is a single check.
+ *
+ * The buffer doesn't track how many elements are readable: the owner publishes that, which lets several
+ * buffers (e.g. the columns of a series) share one counter.
+ */
+template<class T>
+class RingBuffer {
+public:
+    static constexpr size_t CHUNK_SLOTS = 1024;
+
+    explicit RingBuffer(size_t slots)
+            : m_Slots(std::max<size_t>(slots, 1)),
+              m_ChunkSlots(std::min(m_Slots, CHUNK_SLOTS)),
+              m_ChunkCount((m_Slots + m_ChunkSlots - 1) / m_ChunkSlots),
+              m_Chunks(new std::atomic<std::atomic<T> *>[m_ChunkCount]) {
+        for (size_t i = 0; i < m_ChunkCount; ++i) {
+            m_Chunks[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~RingBuffer() {
+        for (size_t i = 0; i < m_ChunkCount; ++i) {
+            delete[] m_Chunks[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(const RingBuffer &) = delete;
+
+    auto operator=(const RingBuffer &) -> RingBuffer & = delete;
+
+    /**
+     * Allocate the chunk holding the slot of `seq` if it wasn't yet. Must only be called from the producer.
+     * @throw std::bad_alloc if the chunk can't be allocated.
+     */
+    auto Reserve(uint64_t seq) -> void {
+        const auto chunk = seq % m_Slots / m_ChunkSlots;
+        if (!m_Chunks[chunk].load(std::memory_order_relaxed)) {
+            const auto slots = std::min(m_ChunkSlots, m_Slots - chunk * m_ChunkSlots);
+            m_Chunks[chunk].store(new std::atomic<T>[slots](), std::memory_order_release);
+        }
+    }
+
+    /**
+     * Store element `seq`, whose slot must have been reserved.
+     */
+    auto Store(uint64_t seq, T value) noexcept -> void {
+        const auto slot = seq % m_Slots;
+        m_Chunks[slot / m_ChunkSlots].load(std::memory_order_relaxed)[slot % m_ChunkSlots].store(
+                value, std::memory_order_relaxed);
+    }
+
+    /**
+     * Element `seq`, or T() if its slot was never stored to.
+     */
+    [[nodiscard]] auto Load(uint64_t seq) const noexcept -> T {
+        const auto slot = seq % m_Slots;
+        const auto *chunk = m_Chunks[slot / m_ChunkSlots].load(std::memory_order_acquire);
+        return chunk ? chunk[slot % m_ChunkSlots].load(std::memory_order_relaxed) : T();
+    }
+
+    [[nodiscard]] auto Slots() const noexcept -> size_t { return m_Slots; }
+
+    /**
+     * Slot of `seq`, followed by Contiguous(seq) - 1 slots holding the next sequence numbers.
+     */
+    [[nodiscard]] auto Data(uint64_t seq) const noexcept -> const std::atomic<T> * {
+        const auto slot = seq % m_Slots;
+        return m_Chunks[slot / m_ChunkSlots].load(std::memory_order_acquire) + slot % m_ChunkSlots;
+    }
+
+    [[nodiscard]] auto Contiguous(uint64_t seq) const noexcept -> size_t {
+        const auto slot = seq % m_Slots;
+        return std::min(m_Slots - slot, m_ChunkSlots - slot % m_ChunkSlots);
+    }
+
+private:
+    size_t m_Slots;
+    size_t m_ChunkSlots;
+    size_t m_ChunkCount;
+    std::unique_ptr<std::atomic<std::atomic<T> *>[]> m_Chunks;
+};
+
+#endif // BUSPLOT_RING_BUFFER_HPP
@@ -1,6 +1,9 @@
 #ifndef BUSPLOT_RPC_PROTOCOL_HPP
 #define BUSPLOT_RPC_PROTOCOL_HPP
 
+#include <cstdint>
+#include <cstddef>
+
 static constexpr uint8_t SOF = 0xA5;
 
 #pragma pack(push, 1)
@@ -26,6 +29,104 @@ struct UpdateVariableReq {
     float m_Value{};
 };
 
+struct UpdateVariableInt16Req {
+    static constexpr uint16_t COMMAND = 0x0022;
+    uint16_t m_VariableId{};
+    int16_t m_Value{};
+};
+
+struct UpdateVariableInt32Req {
+    static constexpr uint16_t COMMAND = 0x0023;
+    uint16_t m_VariableId{};
+    int32_t m_Value{};
+};
+
+struct UpdateVariableDoubleReq {
+    static constexpr uint16_t COMMAND = 0x0024;
+    uint16_t m_VariableId{};
+    double m_Value{};
+};
+
+/**
+ * Samples of several float variables taken at the same time, only the first m_Count of them are sent.
+ */
+struct UpdateVariablesReq {
+    static constexpr uint16_t COMMAND = 0x0025;
+    static constexpr uint8_t MAX_COUNT = 42;
+
+    struct Sample {
+        uint16_t m_VariableId{};
+        float m_Value{};
+    };
+
+    uint8_t m_Count{};
+    Sample m_Samples[MAX_COUNT] = {};
+};
+
+/**
+ * Consecutive samples of a float variable, m_Period apart, only the first m_Count of them are sent.
+ */
+struct UpdateVariableSamplesReq {
+    static constexpr uint16_t COMMAND = 0x0026;
+    static constexpr uint8_t MAX_COUNT = 62;
+    uint16_t m_VariableId{};
+    uint32_t m_Period{};                ///< Microseconds between two samples
+    uint8_t m_Count{};
+    float m_Values[MAX_COUNT] = {};
+};
+
+/**
+ * Like UpdateVariablesReq, the samples being taken at tick m_Tick of the device clock, see DeviceClockReq.
+ */
+struct UpdateVariablesTickedReq {
+    static constexpr uint16_t COMMAND = 0x0027;
+    static constexpr uint8_t MAX_COUNT = 41;
+    uint32_t m_Tick{};
+    uint8_t m_Count{};
+    UpdateVariablesReq::Sample m_Samples[MAX_COUNT] = {};
+};
+
+/**
+ * Like UpdateVariableSamplesReq, the first sample being taken at tick m_Tick of the device clock and the next ones
+ * m_Period ticks apart.
+ */
+struct UpdateVariableTickedSamplesReq {
+    static constexpr uint16_t COMMAND = 0x0028;
+    static constexpr uint8_t MAX_COUNT = 61;
+    uint16_t m_VariableId{};
+    uint32_t m_Tick{};
+    uint32_t m_Period{};                ///< Ticks between two samples
+    uint8_t m_Count{};
+    float m_Values[MAX_COUNT] = {};
+};
+
+/**
+ * Frequency of the clock counting the ticks of the timestamped requests, sent by the device before them.
+ */
+struct DeviceClockReq {
+    static constexpr uint16_t COMMAND = 0x0050;
+    uint32_t m_Frequency{};             ///< Ticks per second
+};
+
+/**
+ * Ping of the host, which the device echoes at once with TimeSyncEchoReq. Both are as long, so that they take as
+ * long on the wire and the tick of the echo is about halfway through the round trip.
+ */
+struct TimeSyncReq {
+    static constexpr uint16_t COMMAND = 0x0060;
+    uint64_t m_HostTime{};              ///< Microseconds since the epoch when the ping was sent
+    uint32_t m_Sequence{};
+};
+
+/**
+ * Echo of TimeSyncReq, stamped with the tick of the device clock at which the ping was received.
+ */
+struct TimeSyncEchoReq {
+    static constexpr uint16_t COMMAND = 0x0061;
+    uint64_t m_HostTime{};              ///< That of the ping, unchanged
+    uint32_t m_Tick{};
+};
+
 struct RemoveVariableReq {
     static constexpr uint16_t COMMAND = 0x0030;
     uint16_t m_VariableId{};
@@ -51,4 +152,50 @@ struct RPCRequest {
 
 #pragma pack(pop)
 
+/**
+ * Body length of requests on the wire. Requests ending with an array of samples are sent without its unused
+ * entries, and are between MIN and MAX bytes long. Of gives the length of a given request, which exceeds MAX when
+ * its m_Count is larger than the array.
+ */
+template<class ReqType>
+struct FrameLength {
+    static constexpr size_t MIN = sizeof(ReqType);
+    static constexpr size_t MAX = sizeof(ReqType);
+
+    static constexpr auto Of(const ReqType &) -> size_t { return sizeof(ReqType); }
+};
+
+/**
+ * FrameLength of a request ending with m_Count samples of SampleType, the first one at `OFFSET`.
+ */
+template<class ReqType, class SampleType, size_t OFFSET>
+struct SampleArrayLength {
+    static constexpr size_t MIN = OFFSET + sizeof(SampleType);
+    static constexpr size_t MAX = sizeof(ReqType);
+    static_assert(MAX <= UINT8_MAX, "Frame bodies are at most 255 bytes long");
+
+    static constexpr auto Of(const ReqType &request) -> size_t { return OFFSET + request.m_Count * sizeof(SampleType); }
+};
+
+template<>
+struct FrameLength<UpdateVariablesReq>
+        : SampleArrayLength<UpdateVariablesReq, UpdateVariablesReq::Sample, offsetof(UpdateVariablesReq, m_Samples)> {
+};
+
+template<>
+struct FrameLength<UpdateVariableSamplesReq>
+        : SampleArrayLength<UpdateVariableSamplesReq, float, offsetof(UpdateVariableSamplesReq, m_Values)> {
+};
+
+template<>
+struct FrameLength<UpdateVariablesTickedReq>
+        : SampleArrayLength<UpdateVariablesTickedReq, UpdateVariablesReq::Sample,
+                            offsetof(UpdateVariablesTickedReq, m_Samples)> {
+};
+
+template<>
+struct FrameLength<UpdateVariableTickedSamplesReq>
+        : SampleArrayLength<UpdateVariableTickedSamplesReq, float, offsetof(UpdateVariableTickedSamplesReq, m_Values)> {
+};
+
 #endif // BUSPLOT_RPC_PROTOCOL_HPP
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef BUSPLOT_SEQLOCK_HPP
+#define BUSPLOT_SEQLOCK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Publishes a small trivially copyable value from a single writer to any number of readers.
+ * The writer never waits, readers retry while a store is in progress.
+ */
+template<class T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock value must be trivially copyable");
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+public:
+    auto Store(const T &value) noexcept -> void {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+        const auto sequence = m_Sequence.load(std::memory_order_relaxed);
+        m_Sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            m_Words[i].store(words[i], std::memory_order_relaxed);
+        }
+        m_Sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    [[nodiscard]] auto Load() const noexcept -> T {
+        uint64_t words[WORDS] = {};
+        uint32_t before, after;
+        do {
+            before = m_Sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; ++i) {
+                words[i] = m_Words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_Sequence.load(std::memory_order_relaxed);
+        } while (before != after || before % 2 != 0);
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+private:
+    std::atomic<uint32_t> m_Sequence{0};
+    std::atomic<uint64_t> m_Words[WORDS]{};
+};
+
+#endif // BUSPLOT_SEQLOCK_HPP
@@ -38,7 +38,7 @@ auto SerialRPC::Connect(const std::string &deviceName, unsigned int baudRate,
 }
 
 auto SerialRPC::StartGrabbing() -> void {
-    ReadAsync(m_SOFBuffer, &SerialRPC::ReadSOFHandler);
+    ReadSome();
     m_WorkingThread = std::make_shared<std::thread>([this]() {
         m_IOS.run();
     });
@@ -60,32 +60,30 @@ auto SerialRPC::StopGrabbing() -> void {
     m_IOS.stop();
 }
 
-auto SerialRPC::ReadHeaderHandler(const boost::system::error_code &err, size_t len) -> void {
-    if (err) {
-        spdlog::warn("SerialPort read header failed: {}", err.message());
-        ReadAsync(m_SOFBuffer, &SerialRPC::ReadSOFHandler);
-        return;
-    }
-    const auto &header = m_HeaderBuffer[0];
-    spdlog::trace("SerialPort: Receive header: Length: {}, Command: {}", header.m_DataLength,
-                  header.m_Command);
-    auto handleIt = m_Callbacks.find(header.m_Command);
-    if (handleIt == m_Callbacks.end()) {
-        spdlog::warn("SerialPort: Ignore command {}", header.m_Command);
-        ReadAsync(m_SOFBuffer, &SerialRPC::ReadSOFHandler);
-        return;
-    }
-    handleIt->second(header.m_DataLength);
+auto SerialRPC::Counters() const noexcept -> FrameScanner::FrameCounters {
+    return m_Scanner->Counters();
 }
 
-auto SerialRPC::ReadSOFHandler(const boost::system::error_code &err, size_t len) -> void {
+auto SerialRPC::ReadSome() -> void {
+    m_SerialPort.async_read_some(asio::buffer(m_Scanner->WritePointer(), m_Scanner->WritableBytes()),
+                                 boost::bind(&SerialRPC::ReadSomeHandler, this, asio::placeholders::error,
+                                             asio::placeholders::bytes_transferred));
+}
+
+auto SerialRPC::ReadSomeHandler(const boost::system::error_code &err, size_t len) -> void {
     if (err) {
-        spdlog::critical("SerialPort read SOF failed: {}", err.message());
+        spdlog::critical("SerialPort read failed: {}", err.message());
         return;
     }
-    if (m_SOFBuffer[0] == SOF) {
-        ReadAsync(m_HeaderBuffer, &SerialRPC::ReadHeaderHandler);
-    } else {
-        ReadAsync(m_SOFBuffer, &SerialRPC::ReadSOFHandler);
-    }
+    m_Scanner->Commit(len);
+    m_Scanner->Scan([this](const FrameScanner::Frame &frame) {
+        spdlog::trace("SerialPort: Receive frame: Length: {}, Command: {}", frame.m_Length, frame.m_Command);
+        const auto handleIt = m_Callbacks.find(frame.m_Command);
+        if (handleIt == m_Callbacks.end()) {
+            spdlog::warn("SerialPort: Ignore command {}", frame.m_Command);
+            return;
+        }
+        handleIt->second(frame);
+    });
+    ReadSome();
 }
@@ -8,16 +8,18 @@
 
 #include <string>
 #include <memory>
+#include <mutex>
+#include <cstring>
 #include <unordered_map>
 
 #include "rpc_protocol.hpp"
 #include "crc.hpp"
+#include "frame_scanner.hpp"
 
 class SerialRPC {
     template<class ReqType>
     using MessageCallBack = std::function<void(const ReqType &)>;
     using CloseCondition = std::function<bool()>;
-    static constexpr size_t MAX_BODY_SIZE = 512;
 public:
 
     SerialRPC();
@@ -41,82 +43,71 @@ public:
 
     auto StopGrabbing() -> void;
 
+    /**
+     * Frames received so far, see FrameScanner.
+     */
+    [[nodiscard]] auto Counters() const noexcept -> FrameScanner::FrameCounters;
+
     template<class ReqType>
     auto RegisterMessage(MessageCallBack<ReqType> process) -> bool {
-        const auto handleRequest = [this, process](size_t dataLength) -> void {
-            if (dataLength != sizeof(ReqType)) {
-                spdlog::warn("SerialPort: Package length {} can't match request type {}, whose size is {}.",
-                             dataLength,
+        // The scanner drops frames of another length, their SOF being most likely a byte of another frame.
+        const auto handleRequest = [process](const FrameScanner::Frame &frame) -> void {
+            ReqType request{};
+            std::memcpy(&request, frame.m_Body, std::min(frame.m_Length, sizeof(ReqType)));
+            if (FrameLength<ReqType>::Of(request) != frame.m_Length) {
+                spdlog::warn("SerialPort: Package length {} can't match request type {}, which should be {}.",
+                             frame.m_Length,
                              typeid(ReqType).name(),
-                             sizeof(ReqType));
-                ReadAsync(m_SOFBuffer, &SerialRPC::ReadSOFHandler);
+                             FrameLength<ReqType>::Of(request));
                 return;
             }
-            boost::asio::async_read(
-                    m_SerialPort, boost::asio::buffer(m_BodyBuffer),
-                    boost::asio::transfer_exactly(sizeof(RPCRequest<ReqType>) - sizeof(FrameHeader) - sizeof(uint8_t)),
-                    boost::bind(&SerialRPC::ReadBodyHandler<ReqType>,
-                                this,
-                                boost::asio::placeholders::error,
-                                boost::asio::placeholders::bytes_transferred,
-                                process));
+            process(request);
         };
         auto[_, suc] = m_Callbacks.insert(std::make_pair(ReqType::COMMAND, handleRequest));
+        if (suc) {
+            m_Scanner->Expect(ReqType::COMMAND, FrameLength<ReqType>::MIN, FrameLength<ReqType>::MAX);
+        }
         return suc;
     }
 
+    /**
+     * Write the frame of a request into `frame`, which must have room for FrameScanner::MAX_FRAME_BYTES.
+     * Requests ending with an array of samples are sent without its unused entries, see FrameLength.
+     * @return The length of the frame.
+     */
     template<class ReqType>
-    static auto MakeRequest(const ReqType &requestBody) -> RPCRequest<ReqType> {
-        auto req = RPCRequest<ReqType>
-                {
-                        SOF,
-                        FrameHeader{sizeof(ReqType), ReqType::COMMAND},
-                        requestBody,
-                        {0}
-                };
-        CRC::AppendCRC16Checksum(reinterpret_cast<uint8_t *>(&req), sizeof(req));
-        return req;
+    static auto MakeFrame(const ReqType &requestBody, uint8_t *frame) -> size_t {
+        const FrameHeader header{static_cast<uint8_t>(FrameLength<ReqType>::Of(requestBody)), ReqType::COMMAND};
+        const auto frameBytes = sizeof(SOF) + sizeof(FrameHeader) + header.m_DataLength + sizeof(FrameTail);
+        frame[0] = SOF;
+        std::memcpy(frame + sizeof(SOF), &header, sizeof(header));
+        std::memcpy(frame + sizeof(SOF) + sizeof(FrameHeader), &requestBody, header.m_DataLength);
+        CRC::AppendCRC16Checksum(frame, frameBytes);
+        return frameBytes;
     }
 
+    /**
+     * Send a request, from any thread.
+     */
     template<class ReqType>
     auto Request(const ReqType requestBody) -> void {
-        std::array<RPCRequest<ReqType>, 1> buffer = {SerialRPC::MakeRequest(requestBody)};
-        boost::asio::write(m_SerialPort, boost::asio::buffer(buffer));
+        std::array<uint8_t, FrameScanner::MAX_FRAME_BYTES> buffer{};
+        const auto frameBytes = SerialRPC::MakeFrame(requestBody, buffer.data());
+        std::lock_guard lock(m_WriteMutex);
+        boost::asio::write(m_SerialPort, boost::asio::buffer(buffer.data(), frameBytes));
     }
 
 private:
 
-    auto ReadSOFHandler(const boost::system::error_code &err, size_t len) -> void;
-
-    auto ReadHeaderHandler(const boost::system::error_code &err, size_t len) -> void;
-
-    template<class ReqType>
-    auto ReadBodyHandler(const boost::system::error_code &err, size_t len, MessageCallBack<ReqType> process) -> void {
-        if (err) {
-            spdlog::warn("SerialPort read body failed: {}", err.message());
-            ReadAsync(m_SOFBuffer, &SerialRPC::ReadSOFHandler);
-            return;
-        }
-        RPCRequest<ReqType> buf{SOF, m_HeaderBuffer[0], {}, {}};
-        std::copy(m_BodyBuffer.begin(),
-                  m_BodyBuffer.begin() + sizeof(RPCRequest<ReqType>) - sizeof(FrameHeader) - sizeof(uint8_t),
-                  reinterpret_cast<uint8_t *>(&buf.m_Request));
-        if (!CRC::VerifyCRC16Checksum(reinterpret_cast<uint8_t *>(&buf), sizeof(buf))) {
-            spdlog::warn("SerialPort CRC16 verify failed");
-            ReadAsync(m_SOFBuffer, &SerialRPC::ReadSOFHandler);
-            return;
-        };
-        process(buf.m_Request);
-        ReadAsync(m_SOFBuffer, &SerialRPC::ReadSOFHandler);
-    }
+    /**
+     * Read whatever was received into the frame scanner, as much as it has room for.
+     */
+    auto ReadSome() -> void;
 
-    template<class BufferType, size_t N, class HandlerType>
-    auto ReadAsync(std::array<BufferType, N> &buffer, HandlerType handler) -> void {
-        boost::asio::async_read(m_SerialPort, boost::asio::buffer(buffer),
-                                boost::asio::transfer_exactly(sizeof(BufferType) * N),
-                                boost::bind(handler, this, boost::asio::placeholders::error,
-                                            boost::asio::placeholders::bytes_transferred));
-    }
+    /**
+     * Handle every complete frame read so far, then read again.
+     */
+    auto ReadSomeHandler(const boost::system::error_code &err, size_t len) -> void;
 
     template<class BufferType>
     auto ReadSerialPort(BufferType &destBuffer) -> bool {
@@ -141,12 +132,10 @@ private:
     boost::asio::io_service m_IOS;
     boost::asio::serial_port m_SerialPort;
     boost::asio::streambuf m_Buffer;
-    std::unordered_map<uint16_t, std::function<void(size_t)>> m_Callbacks;
+    std::unordered_map<uint16_t, std::function<void(const FrameScanner::Frame &)>> m_Callbacks;
     bool m_IsValid = false;
-
-    std::array<uint8_t, 1> m_SOFBuffer{};
-    std::array<FrameHeader, 1> m_HeaderBuffer{};
-    std::array<uint8_t, MAX_BODY_SIZE> m_BodyBuffer{};
+    std::unique_ptr<FrameScanner> m_Scanner = std::make_unique<FrameScanner>();
+    std::mutex m_WriteMutex;            ///< Frames of requests sent from several threads must not interleave
 };
 
 #endif // BUSPLOT_SERIAL_RPC_HPP
\ No newline at end of file
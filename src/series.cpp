@@ -1,46 +1,605 @@
 
+#include <spdlog/spdlog.h>
+
 #include <vector>
 #include <mutex>
 #include <chrono>
+#include <cstdlib>
 #include <algorithm>
+#include <new>
 
 #include "series.hpp"
 
-Series::Series(const std::string &label) : m_Label(label) {}
+template<class T>
+SeriesStorage<T>::SeriesStorage(size_t capacity, Timebase timebase)
+        : m_Capacity(std::max<size_t>(capacity, 1)),
+          m_Timebase(timebase),
+          m_Timestamps(timebase == Timebase::Explicit ? m_Capacity + READER_SLACK : 0),
+          m_Values(m_Capacity + READER_SLACK),
+          m_RunFirsts(timebase == Timebase::Implicit ? (m_Capacity + READER_SLACK) / SAMPLES_PER_RUN + 2 : 0),
+          m_RunStarts(m_RunFirsts.Slots()),
+          m_RunPeriods(m_RunFirsts.Slots()),
+          m_Pyramid(m_Capacity, READER_SLACK) {}
+
+template<class T>
+auto SeriesStorage<T>::Push(Timestamp time, T value) -> bool {
+    const auto seq = m_Committed.load(std::memory_order_relaxed);
+    // Allocate every slot this sample may be stored to before changing anything.
+    if (m_Timebase == Timebase::Explicit) {
+        m_Timestamps.Reserve(seq);
+    } else {
+        const auto runCount = m_RunCount.load(std::memory_order_relaxed);
+        m_RunFirsts.Reserve(runCount);
+        m_RunStarts.Reserve(runCount);
+        m_RunPeriods.Reserve(runCount);
+    }
+    m_Values.Reserve(seq);
+    m_Pyramid.Reserve();
+    if (m_Timebase == Timebase::Implicit && !Extend(seq, time)) {
+        return false;
+    }
+    // Order the publication of the previous sample before overwriting any slot, see IsIntact.
+    std::atomic_thread_fence(std::memory_order_release);
+    if (m_Timebase == Timebase::Explicit) {
+        m_Timestamps.Store(seq, time);
+    }
+    m_Values.Store(seq, value);
+    m_Committed.store(seq + 1, std::memory_order_release);
+    m_Pyramid.Push(time, value);
+    return true;
+}
+
+template<class T>
+auto SeriesStorage<T>::Extend(uint64_t seq, Timestamp &time) noexcept -> bool {
+    const auto runCount = m_RunCount.load(std::memory_order_relaxed);
+    if (runCount > 0) {
+        if (m_RunPeriod == 0) {
+            if (time > m_RunStart) {
+                // The second sample of a run sets its period, before being published.
+                m_RunPeriod = time - m_RunStart;
+                m_RunPeriods.Store(runCount - 1, m_RunPeriod);
+                m_LastTime = time;
+                return true;
+            }
+        } else {
+            const auto expected = m_RunStart + static_cast<Timestamp>(seq - m_RunFirst) * m_RunPeriod;
+            if (std::abs(time - expected) <= m_RunPeriod / JITTER_TOLERANCE) {
+                time = expected;
+                m_LastTime = time;
+                return true;
+            }
+        }
+    }
+    // A run slot can be reused once every sample of the run it holds is older than any intact one.
+    const auto runSlots = m_RunFirsts.Slots();
+    if (runCount >= runSlots) {
+        const auto next = m_RunFirsts.Load(runCount - runSlots + 1);
+        if (seq < m_Values.Slots() || next > seq - m_Values.Slots()) {
+            return false;
+        }
+    }
+    m_RunFirst = seq;
+    m_RunStart = std::max(time, m_LastTime);
+    m_RunPeriod = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    m_RunFirsts.Store(runCount, m_RunFirst);
+    m_RunStarts.Store(runCount, m_RunStart);
+    m_RunPeriods.Store(runCount, 0);
+    m_RunCount.store(runCount + 1, std::memory_order_release);
+    time = m_RunStart;
+    m_LastTime = time;
+    return true;
+}
+
+template<class T>
+auto SeriesStorage<T>::Committed() const noexcept -> uint64_t {
+    return m_Committed.load(std::memory_order_acquire);
+}
+
+template<class T>
+auto SeriesStorage<T>::Capacity() const noexcept -> size_t {
+    return m_Capacity;
+}
+
+template<class T>
+auto SeriesStorage<T>::Oldest(uint64_t committed) const noexcept -> uint64_t {
+    return committed > m_Capacity ? committed - m_Capacity : 0;
+}
+
+template<class T>
+auto SeriesStorage<T>::IsIntact(uint64_t seq) const noexcept -> bool {
+    // If a slot read before this fence already held an overwriting sample, the load below sees its publication.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return m_Committed.load(std::memory_order_relaxed) < seq + m_Values.Slots();
+}
+
+template<class T>
+auto SeriesStorage<T>::TimeAt(uint64_t seq) const noexcept -> Timestamp {
+    if (m_Timebase == Timebase::Explicit) {
+        return m_Timestamps.Load(seq);
+    }
+    const auto run = RunOf(seq);
+    return RunStart(run) + static_cast<Timestamp>(seq - RunFirst(run)) * RunPeriod(run);
+}
+
+template<class T>
+auto SeriesStorage<T>::ValueData(uint64_t seq) const noexcept -> const T * {
+    return reinterpret_cast<const T *>(m_Values.Data(seq));
+}
+
+template<class T>
+auto SeriesStorage<T>::RunOf(uint64_t seq) const noexcept -> uint64_t {
+    const auto runCount = RunCount();
+    uint64_t first = runCount > m_RunFirsts.Slots() ? runCount - m_RunFirsts.Slots() : 0;
+    uint64_t last = std::max<uint64_t>(runCount, 1);
+    // Find the last run starting at or before `seq`. A run overwritten meanwhile is older than any intact sample.
+    while (last - first > 1) {
+        const auto mid = first + (last - first) / 2;
+        if (RunFirst(mid) <= seq || !IsRunIntact(mid)) {
+            first = mid;
+        } else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
+template<class T>
+auto SeriesStorage<T>::RunCount() const noexcept -> uint64_t {
+    return m_RunCount.load(std::memory_order_acquire);
+}
 
-auto Series::AddData(Dot data) -> void {
-    std::lock_guard<std::mutex> guard(m_Mutex);
-    m_Data.push_back(data);
+template<class T>
+auto SeriesStorage<T>::IsRunIntact(uint64_t run) const noexcept -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return m_RunCount.load(std::memory_order_relaxed) < run + m_RunFirsts.Slots();
 }
 
-auto Series::GenerateDots(const TimeType &beginTime, const TimeType &endTime) -> std::vector<Dot> {
-    std::lock_guard<std::mutex> guard(m_Mutex);
-    const auto rangeBegin = std::lower_bound(
-            m_Data.begin(), m_Data.end(), beginTime,
-            [](const Dot &lhs, const TimeType &rhs) {
-                return lhs.m_Time * 1000000 < std::chrono::duration_cast<Duration>(rhs.time_since_epoch()).count();
-            });
-    const auto rangeEnd = std::upper_bound(
-            m_Data.begin(), m_Data.end(), endTime,
-            [](const TimeType &lhs, const Dot &rhs) {
-                return std::chrono::duration_cast<Duration>(lhs.time_since_epoch()).count() < rhs.m_Time * 1000000;
-            });
-    if (rangeBegin == m_Data.end()) {
-        return std::vector<Dot>(); ///< No data;
+template<class T>
+static auto LevelTimeAt(const SeriesStorage<T> &storage, size_t level, uint64_t index) noexcept -> Timestamp {
+    return level == 0 ? storage.TimeAt(index) : storage.Pyramid().TimeAt(level, index);
+}
+
+/**
+ * First index in [first, last) of a level whose timestamp is not less than `time`.
+ */
+template<class T>
+static auto LowerBound(const SeriesStorage<T> &storage, size_t level, uint64_t first, uint64_t last,
+                       Timestamp time) -> uint64_t {
+    while (first < last) {
+        const auto mid = first + (last - first) / 2;
+        if (LevelTimeAt(storage, level, mid) < time) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
     }
-    return std::vector<Dot>(rangeBegin, rangeEnd);
+    return first;
 }
 
-auto Series::Data() const noexcept -> const std::vector<Dot> & {
-    return m_Data;
+/**
+ * First index in [first, last) of a level whose timestamp is greater than `time`.
+ */
+template<class T>
+static auto UpperBound(const SeriesStorage<T> &storage, size_t level, uint64_t first, uint64_t last,
+                       Timestamp time) -> uint64_t {
+    while (first < last) {
+        const auto mid = first + (last - first) / 2;
+        if (time < LevelTimeAt(storage, level, mid)) {
+            last = mid;
+        } else {
+            first = mid + 1;
+        }
+    }
+    return first;
 }
 
-auto Series::Label() const noexcept -> std::string {
+/**
+ * Summary buckets per archived chunk giving about `resolution` entries over `chunks`, 0 if they should be
+ * decoded in full because they hold no more samples than that.
+ */
+static auto SummaryBuckets(const std::vector<SeriesArchive::Chunk> &chunks, size_t resolution) -> size_t {
+    size_t samples = 0;
+    for (const auto &chunk : chunks) {
+        samples += chunk.m_Count;
+    }
+    if (resolution == 0 || samples <= resolution) {
+        return 0;
+    }
+    size_t buckets = 1;
+    while (buckets < SeriesArchive::SUMMARY_BUCKETS && 2 * buckets * chunks.size() <= resolution) {
+        buckets *= 2;
+    }
+    return buckets;
+}
+
+template<class T>
+auto SeriesView<T>::AddSegment(size_t level, uint64_t begin, uint64_t end) noexcept -> void {
+    if (begin >= end || m_SegmentCount == MAX_SEGMENTS) {
+        return;
+    }
+    m_Segments[m_SegmentCount++] = Segment{level, begin, end, m_Size};
+    m_Size += static_cast<size_t>(end - begin) * (level == 0 ? 1 : 2);
+}
+
+template<class T>
+auto SeriesView<T>::AddHistory(std::shared_ptr<const SeriesArchive::DecodedChunk<T>> chunk,
+                            size_t begin,
+                            size_t end) -> void {
+    if (begin >= end) {
+        return;
+    }
+    m_History.push_back(HistorySegment{std::move(chunk), begin, m_Size});
+    m_Size += end - begin;
+    m_HistorySize = m_Size;
+}
+
+template<class T>
+auto SeriesView<T>::LocateHistory(size_t &index) const noexcept -> const HistorySegment & {
+    const auto it = std::upper_bound(m_History.begin(), m_History.end(), index,
+                                     [](size_t point, const HistorySegment &segment) {
+                                         return point < segment.m_FirstPoint;
+                                     }) - 1;
+    index -= it->m_FirstPoint;
+    return *it;
+}
+
+template<class T>
+auto SeriesView<T>::Locate(size_t &index) const noexcept -> const Segment & {
+    size_t segment = 0;
+    while (segment + 1 < m_SegmentCount && m_Segments[segment + 1].m_FirstPoint <= index) {
+        ++segment;
+    }
+    index -= m_Segments[segment].m_FirstPoint;
+    return m_Segments[segment];
+}
+
+template<class T>
+auto SeriesView<T>::TimeAt(size_t index) const noexcept -> Timestamp {
+    if (index < m_HistorySize) {
+        const auto &history = LocateHistory(index);
+        return history.m_Chunk->m_Times[history.m_Begin + index];
+    }
+    const auto &segment = Locate(index);
+    if (segment.m_Level == 0) {
+        return m_Storage->TimeAt(segment.m_Begin + index);
+    }
+    return m_Storage->Pyramid().TimeAt(segment.m_Level, segment.m_Begin + index / 2);
+}
+
+template<class T>
+auto SeriesView<T>::ValueAt(size_t index) const noexcept -> T {
+    if (index < m_HistorySize) {
+        const auto &history = LocateHistory(index);
+        return history.m_Chunk->m_Values[history.m_Begin + index];
+    }
+    const auto &segment = Locate(index);
+    if (segment.m_Level == 0) {
+        return m_Storage->ValueAt(segment.m_Begin + index);
+    }
+    const auto bucket = segment.m_Begin + index / 2;
+    return index % 2 == 0
+           ? m_Storage->Pyramid().MinAt(segment.m_Level, bucket)
+           : m_Storage->Pyramid().MaxAt(segment.m_Level, bucket);
+}
+
+template<class T>
+auto SeriesView<T>::UniformSpans() const -> std::vector<UniformSpan> {
+    std::vector<UniformSpan> spans;
+    if (m_Storage->GetTimebase() != Timebase::Implicit) {
+        return spans;
+    }
+    for (size_t i = 0; i < m_SegmentCount; ++i) {
+        const auto &segment = m_Segments[i];
+        if (segment.m_Level != 0) {
+            continue;
+        }
+        auto seq = segment.m_Begin;
+        for (auto run = m_Storage->RunOf(seq); seq < segment.m_End; ++run) {
+            const auto runFirst = m_Storage->RunFirst(run);
+            const auto runEnd = run + 1 < m_Storage->RunCount()
+                                ? std::min(m_Storage->RunFirst(run + 1), segment.m_End)
+                                : segment.m_End;
+            if (runFirst > seq || runEnd <= seq) {
+                break; ///< Overwritten while reading, IsIntact tells
+            }
+            const auto period = m_Storage->RunPeriod(run);
+            const auto start = m_Storage->RunStart(run) + static_cast<Timestamp>(seq - runFirst) * period;
+            for (auto first = seq; period > 0 && first < runEnd;) {
+                const auto count = std::min<uint64_t>(runEnd - first, m_Storage->ContiguousValues(first));
+                spans.push_back(UniformSpan{segment.m_FirstPoint + static_cast<size_t>(first - segment.m_Begin),
+                                            static_cast<size_t>(count),
+                                            m_Storage->ValueData(first),
+                                            start + static_cast<Timestamp>(first - seq) * period,
+                                            period});
+                first += count;
+            }
+            seq = runEnd;
+        }
+    }
+    return spans;
+}
+
+template<class T>
+auto SeriesView<T>::IsIntact() const noexcept -> bool {
+    for (size_t i = 0; i < m_SegmentCount; ++i) {
+        const auto &segment = m_Segments[i];
+        if (segment.m_Level == 0
+            ? !m_Storage->IsIntact(segment.m_Begin)
+            : !m_Storage->Pyramid().IsIntact(segment.m_Level, segment.m_Begin)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::atomic<size_t> SeriesBase::s_DefaultCapacity{SeriesBase::DEFAULT_CAPACITY};
+std::atomic<Timebase> SeriesBase::s_DefaultTimebase{Timebase::Explicit};
+
+SeriesBase::SeriesBase(const std::string &label) : m_Label(label) {}
+
+auto SeriesBase::Stats() const noexcept -> Statistics {
+    return m_Statistics.Load();
+}
+
+auto SeriesBase::SetCapacity(size_t capacity) -> void {
+    m_PendingCapacity = std::max<size_t>(capacity, 1);
+}
+
+auto SeriesBase::SetTimebase(Timebase timebase) -> void {
+    m_PendingTimebase = timebase;
+    m_TimebasePending = true;
+}
+
+auto SeriesBase::DefaultCapacity() noexcept -> size_t {
+    return s_DefaultCapacity.load();
+}
+
+auto SeriesBase::SetDefaultCapacity(size_t capacity) noexcept -> void {
+    s_DefaultCapacity = capacity;
+}
+
+auto SeriesBase::DefaultTimebase() noexcept -> Timebase {
+    return s_DefaultTimebase.load();
+}
+
+auto SeriesBase::SetDefaultTimebase(Timebase timebase) noexcept -> void {
+    s_DefaultTimebase = timebase;
+}
+
+auto SeriesBase::Label() const noexcept -> std::string {
     std::lock_guard<std::mutex> guard(m_LabelMutex);
     return m_Label;
 }
 
-auto Series::SetLabel(const std::string &label) -> void {
+auto SeriesBase::SetLabel(const std::string &label) -> void {
     std::lock_guard<std::mutex> guard(m_LabelMutex);
     m_Label = label;
 }
+
+auto SeriesBase::EnableArchive(const std::filesystem::path &path) -> void {
+    if (!std::atomic_load(&m_Archive)) {
+        std::atomic_store(&m_Archive, std::make_shared<SeriesArchive>(path));
+    }
+}
+
+auto SeriesBase::Archive() const -> std::shared_ptr<const SeriesArchive> {
+    return std::atomic_load(&m_Archive);
+}
+
+template<class T>
+Series<T>::Series(const std::string &label) : Series(label, DefaultCapacity()) {}
+
+template<class T>
+Series<T>::Series(const std::string &label, size_t capacity)
+        : SeriesBase(label),
+          m_Storage(std::make_shared<SeriesStorage<T>>(capacity, DefaultTimebase())),
+          m_WriterStorage(m_Storage) {}
+
+template<class T>
+auto Series<T>::AddData(const TimeType &time, T value) -> void {
+    Push(time, value);
+    m_Statistics.Store(m_RunningStatistics.Snapshot());
+}
+
+template<class T>
+auto Series<T>::AddData(const TimeType &time, Duration period, const T *values, size_t count) -> void {
+    auto first = time;
+    if (count > 0 && first.time_since_epoch().count() <= m_NewestTime) {
+        first = TimeType(Duration(m_NewestTime)) + std::max(period, Duration(1));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        Push(first + period * static_cast<Duration::rep>(i), values[i]);
+    }
+    if (count > 0) {
+        m_Statistics.Store(m_RunningStatistics.Snapshot());
+    }
+}
+
+template<class T>
+auto Series<T>::Push(const TimeType &time, T value) -> void {
+    if (m_PendingCapacity.load(std::memory_order_relaxed) != 0 || m_TimebasePending.load(std::memory_order_relaxed)) {
+        const auto capacity = m_PendingCapacity.exchange(0);
+        const auto timebase = m_TimebasePending.exchange(false) ? m_PendingTimebase.load()
+                                                                : m_WriterStorage->GetTimebase();
+        Reallocate(capacity != 0 ? capacity : m_WriterStorage->Capacity(), timebase);
+    }
+    const auto timestamp = std::max(time.time_since_epoch().count(), m_NewestTime);
+    try {
+        if (!m_WriterStorage->Push(timestamp, value)) {
+            spdlog::info("Series {}: Too much jitter for an implicit timebase, storing every timestamp", Label());
+            Reallocate(m_WriterStorage->Capacity(), Timebase::Explicit);
+            (void) m_WriterStorage->Push(timestamp, value);
+        }
+    } catch (const std::bad_alloc &) {
+        spdlog::error("Series {}: Out of memory, sample dropped", Label());
+        return;
+    }
+    m_NewestTime = timestamp;
+    m_RunningStatistics.Push(value);
+}
+
+template<class T>
+auto Series<T>::View(const TimeType &beginTime, const TimeType &endTime, size_t resolution) const -> SeriesView<T> {
+    const auto begin = beginTime.time_since_epoch().count();
+    const auto end = endTime.time_since_epoch().count();
+    auto storage = Storage();
+    const auto &pyramid = storage->Pyramid();
+
+    // Snapshot from the coarsest level down, so each level covers at least what the coarser ones do.
+    uint64_t committed[MinMaxPyramid<T>::MAX_LEVELS + 1] = {};
+    for (auto level = pyramid.Levels(); level > 0; --level) {
+        committed[level] = pyramid.Committed(level);
+    }
+    committed[0] = storage->Committed();
+
+    auto archive = std::atomic_load(&m_Archive);
+    SeriesView<T> view(storage, archive);
+    auto storageBegin = begin; ///< Earlier samples come from the archive
+    const auto oldestTime = committed[0] > 0
+                            ? storage->TimeAt(storage->Oldest(committed[0]))
+                            : std::numeric_limits<Timestamp>::max();
+    if (archive && begin < oldestTime) {
+        const auto historyEnd = std::min(end, oldestTime - 1);
+        const auto chunks = archive->Chunks(begin, historyEnd);
+        const auto buckets = SummaryBuckets(chunks, resolution);
+        for (const auto &chunk : chunks) {
+            auto decoded = buckets > 0 ? archive->Summarize<T>(chunk, buckets) : archive->Decode<T>(chunk);
+            if (!decoded) {
+                continue;
+            }
+            const auto &times = decoded->m_Times;
+            auto first = std::lower_bound(times.begin(), times.end(), begin);
+            if (buckets > 0) {
+                // Like pyramid buckets, the bucket holding `begin` starts before it. Times come in pairs.
+                first = std::upper_bound(times.begin(), times.end(), begin);
+                first -= std::min<ptrdiff_t>(first - times.begin(), 2);
+            }
+            const auto last = std::upper_bound(first, times.end(), historyEnd);
+            view.AddHistory(std::move(decoded), first - times.begin(), last - times.begin());
+        }
+        storageBegin = oldestTime;
+    }
+    const auto hasHistory = !view.Empty();
+
+    const auto rawBegin = LowerBound(*storage, 0, storage->Oldest(committed[0]), committed[0], storageBegin);
+    const auto rawEnd = UpperBound(*storage, 0, rawBegin, committed[0], end);
+    size_t level = 0;
+    if (resolution > 0) {
+        while (level < pyramid.Levels() && (rawEnd - rawBegin) / MinMaxPyramid<T>::BucketSize(level) > resolution) {
+            ++level;
+        }
+    }
+
+    if (level == 0) {
+        view.AddSegment(0, rawBegin, rawEnd);
+        return view;
+    }
+    uint64_t covered = 0; ///< First index of the current level not covered by coarser segments
+    for (;; --level) {
+        const auto oldest = level == 0 ? storage->Oldest(committed[0]) : pyramid.Oldest(level, committed[level]);
+        auto first = LowerBound(*storage, level, oldest, committed[level], storageBegin);
+        if (level > 0 && first > oldest && !hasHistory) {
+            --first; ///< This bucket may start before `begin` but still contains samples after it
+        }
+        first = std::max(first, covered);
+        const auto last = UpperBound(*storage, level, first, committed[level], end);
+        view.AddSegment(level, first, last);
+        if (level == 0 || last < committed[level]) {
+            break; ///< The range ends within this level
+        }
+        covered = std::max(first, last) * MinMaxPyramid<T>::FANOUT;
+    }
+    return view;
+}
+
+template<class T>
+auto Series<T>::LastValue() const -> std::optional<double> {
+    const auto storage = Storage();
+    const auto committed = storage->Committed();
+    if (committed == 0) {
+        return std::nullopt;
+    }
+    return static_cast<double>(storage->ValueAt(committed - 1));
+}
+
+template<class T>
+auto Series<T>::Capacity() const -> size_t {
+    const auto pending = m_PendingCapacity.load();
+    return pending != 0 ? pending : Storage()->Capacity();
+}
+
+template<class T>
+auto Series<T>::GetTimebase() const -> Timebase {
+    return m_TimebasePending.load() ? m_PendingTimebase.load() : Storage()->GetTimebase();
+}
+
+template<class T>
+auto Series<T>::Storage() const -> std::shared_ptr<const SeriesStorage<T>> {
+    return std::atomic_load(&m_Storage);
+}
+
+template<class T>
+auto Series<T>::Reallocate(size_t capacity, Timebase timebase) -> void {
+    auto storage = std::make_shared<SeriesStorage<T>>(capacity, timebase);
+    const auto committed = m_WriterStorage->Committed();
+    const auto oldest = std::max(m_WriterStorage->Oldest(committed),
+                                 committed - std::min<uint64_t>(committed, storage->Capacity()));
+    for (auto seq = oldest; seq < committed; ++seq) {
+        if (!storage->Push(m_WriterStorage->TimeAt(seq), m_WriterStorage->ValueAt(seq))) {
+            Reallocate(capacity, Timebase::Explicit); ///< The kept samples already jitter too much
+            return;
+        }
+    }
+    m_WriterStorage = storage;
+    std::atomic_store(&m_Storage, storage);
+}
+
+template<class T>
+auto Series<T>::ArchivePending() -> bool {
+    const auto archive = std::atomic_load(&m_Archive);
+    if (!archive) {
+        return true;
+    }
+    const auto storage = Storage();
+    if (storage != m_ArchivedStorage) {
+        // The storage was reallocated and renumbered, resume after the last archived timestamp.
+        const auto committed = storage->Committed();
+        m_ArchivedStorage = storage;
+        m_ArchivedSeq = UpperBound(*storage, 0, storage->Oldest(committed), committed, m_ArchivedTime);
+    }
+    m_ArchiveTimes.resize(SeriesArchive::CHUNK_SAMPLES);
+    m_ArchiveValues.resize(SeriesArchive::CHUNK_SAMPLES);
+    while (true) {
+        const auto committed = storage->Committed();
+        m_ArchivedSeq = std::max(m_ArchivedSeq, storage->Oldest(committed)); ///< Skip what was overwritten already
+        if (committed - m_ArchivedSeq < SeriesArchive::CHUNK_SAMPLES) {
+            return true;
+        }
+        for (size_t i = 0; i < SeriesArchive::CHUNK_SAMPLES; ++i) {
+            m_ArchiveTimes[i] = storage->TimeAt(m_ArchivedSeq + i);
+            m_ArchiveValues[i] = storage->ValueAt(m_ArchivedSeq + i);
+        }
+        if (!storage->IsIntact(m_ArchivedSeq)) {
+            continue;
+        }
+        if (!archive->Append(m_ArchiveTimes.data(), m_ArchiveValues.data(), SeriesArchive::CHUNK_SAMPLES)) {
+            return false;
+        }
+        m_ArchivedSeq += SeriesArchive::CHUNK_SAMPLES;
+        m_ArchivedTime = m_ArchiveTimes.back();
+    }
+}
+
+template class SeriesStorage<int16_t>;
+template class SeriesStorage<int32_t>;
+template class SeriesStorage<float>;
+template class SeriesStorage<double>;
+template class SeriesView<int16_t>;
+template class SeriesView<int32_t>;
+template class SeriesView<float>;
+template class SeriesView<double>;
+template class Series<int16_t>;
+template class Series<int32_t>;
+template class Series<float>;
+template class Series<double>;
\ No newline at end of file
@@ -5,35 +5,442 @@
 #include <mutex>
 #include <chrono>
 #include <string>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <limits>
+#include <filesystem>
+
+#include "ring_buffer.hpp"
+#include "pyramid.hpp"
+#include "seqlock.hpp"
+#include "statistics.hpp"
+#include "archive.hpp"
 
 using Clock = std::chrono::system_clock;
 using TimeType = std::chrono::time_point<std::chrono::system_clock, std::chrono::microseconds>;
 using Duration = std::chrono::microseconds;
 
-struct Dot {
-    double m_Time{};
-    double m_Value{};
+/**
+ * Timestamp of a stored sample, in microseconds since epoch.
+ */
+using Timestamp = int64_t;
+
+/**
+ * Value types a series can store, see Series.
+ */
+enum class ValueType {
+    Int16,
+    Int32,
+    Float,
+    Double,
+};
+
+template<class T>
+struct ValueTypeOf;
+
+template<>
+struct ValueTypeOf<int16_t> {
+    static constexpr ValueType VALUE = ValueType::Int16;
+};
+
+template<>
+struct ValueTypeOf<int32_t> {
+    static constexpr ValueType VALUE = ValueType::Int32;
+};
+
+template<>
+struct ValueTypeOf<float> {
+    static constexpr ValueType VALUE = ValueType::Float;
+};
+
+template<>
+struct ValueTypeOf<double> {
+    static constexpr ValueType VALUE = ValueType::Double;
+};
+
+/**
+ * How a SeriesStorage keeps the timestamps of its samples.
+ */
+enum class Timebase {
+    Explicit, ///< One timestamp per sample
+    Implicit, ///< Runs of uniformly spaced samples, each stored as a start time and a period
 };
 
-class Series {
+/**
+ * Sample storage of a series, shared by the ingestion thread and the readers without locking.
+ * Samples are stored column-wise: one column of integer timestamps and one of values.
+ *
+ * With an implicit timebase the timestamp column is replaced by a much smaller table of runs. A sample joins the
+ * current run when it is within 1 / JITTER_TOLERANCE of a period from the time the run predicts, and is then
+ * stored at the predicted time. Otherwise it starts a new run at its own timestamp, so jittery segments fall back
+ * to one explicit timestamp per run. A run is never overwritten while any sample a reader may look at belongs to
+ * it: a series jittering that much is out of runs, and must switch to the explicit timebase.
+ *
+ * The producer writes the sample with sequence number Committed() and then publishes it by incrementing
+ * Committed(). Readers only look at the newest Capacity() committed samples, while the columns have
+ * READER_SLACK extra slots: the producer can push that many samples before overwriting the oldest sample
+ * a reader may still be looking at.
+ * Each pushed sample is also summarized into a MinMaxPyramid used to draw long time ranges.
+ *
+ * Values are stored as T, one of the types of ValueType.
+ */
+template<class T>
+class SeriesStorage {
+    static_assert(sizeof(std::atomic<T>) == sizeof(T) && std::atomic<T>::is_always_lock_free,
+                  "Values are handed out as plain arrays");
 public:
-    explicit Series(const std::string &label);
+    static constexpr size_t READER_SLACK = 4096;
+    static constexpr size_t SAMPLES_PER_RUN = 64; ///< Sample slots per run slot of an implicit timebase
+    static constexpr Timestamp JITTER_TOLERANCE = 8;
+
+    explicit SeriesStorage(size_t capacity, Timebase timebase = Timebase::Explicit);
+
+    /**
+     * Append a sample. Must only be called from the producer thread.
+     * @return false if the sample must start a run but the storage is out of runs. Nothing is stored then.
+     * @throw std::bad_alloc if the slots of the sample can't be allocated, see RingBuffer. Nothing is stored then.
+     */
+    [[nodiscard]] auto Push(Timestamp time, T value) -> bool;
+
+    [[nodiscard]] auto GetTimebase() const noexcept -> Timebase { return m_Timebase; }
+
+    [[nodiscard]] auto Committed() const noexcept -> uint64_t;
+
+    [[nodiscard]] auto Capacity() const noexcept -> size_t;
+
+    /**
+     * Sequence number of the oldest sample readers may look at, given a committed count.
+     */
+    [[nodiscard]] auto Oldest(uint64_t committed) const noexcept -> uint64_t;
+
+    /**
+     * Check that the samples from `seq` onwards have not been overwritten since they were read.
+     * Call it after reading them.
+     */
+    [[nodiscard]] auto IsIntact(uint64_t seq) const noexcept -> bool;
+
+    [[nodiscard]] auto TimeAt(uint64_t seq) const noexcept -> Timestamp;
+
+    [[nodiscard]] auto ValueAt(uint64_t seq) const noexcept -> T { return m_Values.Load(seq); }
+
+    /**
+     * Values from `seq` on, contiguous in memory up to ContiguousValues(seq) of them.
+     */
+    [[nodiscard]] auto ValueData(uint64_t seq) const noexcept -> const T *;
 
-    auto AddData(Dot data) -> void;
+    [[nodiscard]] auto ContiguousValues(uint64_t seq) const noexcept -> size_t { return m_Values.Contiguous(seq); }
 
-    auto GenerateDots(const TimeType &beginTime, const TimeType &endTime) -> std::vector<Dot>;
+    /**
+     * Implicit timebase only: the run holding a sample, valid as long as the sample is intact.
+     */
+    [[nodiscard]] auto RunOf(uint64_t seq) const noexcept -> uint64_t;
 
-    [[nodiscard]] auto Data() const noexcept -> const std::vector<Dot> &;
+    [[nodiscard]] auto RunCount() const noexcept -> uint64_t;
+
+    [[nodiscard]] auto RunFirst(uint64_t run) const noexcept -> uint64_t { return m_RunFirsts.Load(run); }
+
+    [[nodiscard]] auto RunStart(uint64_t run) const noexcept -> Timestamp { return m_RunStarts.Load(run); }
+
+    /**
+     * Period of a run, 0 as long as it holds a single sample.
+     */
+    [[nodiscard]] auto RunPeriod(uint64_t run) const noexcept -> Timestamp { return m_RunPeriods.Load(run); }
+
+    [[nodiscard]] auto IsRunIntact(uint64_t run) const noexcept -> bool;
+
+    [[nodiscard]] auto Pyramid() const noexcept -> const MinMaxPyramid<T> & { return m_Pyramid; }
+
+private:
+    /**
+     * Fit a sample of the implicit timebase into the current run, or start a new one.
+     * @param time Replaced by the timestamp the sample is stored at.
+     */
+    auto Extend(uint64_t seq, Timestamp &time) noexcept -> bool;
+
+    size_t m_Capacity;
+    Timebase m_Timebase;
+    RingBuffer<Timestamp> m_Timestamps;
+    RingBuffer<T> m_Values;
+    std::atomic<uint64_t> m_Committed{0};
+    RingBuffer<uint64_t> m_RunFirsts;
+    RingBuffer<Timestamp> m_RunStarts;
+    RingBuffer<Timestamp> m_RunPeriods;
+    std::atomic<uint64_t> m_RunCount{0};
+    MinMaxPyramid<T> m_Pyramid;
+
+    // Current run, only touched by the producer.
+    uint64_t m_RunFirst = 0;
+    Timestamp m_RunStart = 0;
+    Timestamp m_RunPeriod = 0;
+    Timestamp m_LastTime = std::numeric_limits<Timestamp>::min();
+};
+
+/**
+ * Read-only window over the points of a series in a time range. The samples are not copied.
+ * The view keeps the storage it was taken from alive, and ingestion keeps going while it is used.
+ *
+ * The view is made of consecutive segments, each taken from one level of detail: raw samples give one point
+ * each, pyramid buckets give two points (their minimum then their maximum) at the bucket timestamp.
+ * Samples older than the storage are read from archived chunks, which come first.
+ */
+template<class T>
+class SeriesView {
+public:
+    static constexpr size_t MAX_SEGMENTS = MinMaxPyramid<T>::MAX_LEVELS + 1;
+
+    /**
+     * Consecutive points of the view sampled at a constant period, whose values are contiguous in memory.
+     */
+    struct UniformSpan {
+        size_t m_FirstPoint;
+        size_t m_Count;
+        const T *m_Values;
+        Timestamp m_Start; ///< Timestamp of the first point
+        Timestamp m_Period;
+    };
+
+    explicit SeriesView(std::shared_ptr<const SeriesStorage<T>> storage,
+                        std::shared_ptr<const SeriesArchive> archive = nullptr) noexcept
+            : m_Storage(std::move(storage)), m_Archive(std::move(archive)) {}
+
+    /**
+     * Append the samples [begin, end) of a decoded archived chunk after the current last point.
+     * History must be added before any segment of the storage.
+     */
+    auto AddHistory(std::shared_ptr<const SeriesArchive::DecodedChunk<T>> chunk, size_t begin, size_t end) -> void;
+
+    /**
+     * Append the entries [begin, end) of a level (0 for raw samples) after the current last point.
+     */
+    auto AddSegment(size_t level, uint64_t begin, uint64_t end) noexcept -> void;
+
+    [[nodiscard]] auto Size() const noexcept -> size_t { return m_Size; }
+
+    [[nodiscard]] auto Empty() const noexcept -> bool { return m_Size == 0; }
+
+    /**
+     * Level of detail of the first segment, 0 if the view shows raw samples.
+     */
+    [[nodiscard]] auto Level() const noexcept -> size_t { return m_SegmentCount ? m_Segments[0].m_Level : 0; }
+
+    [[nodiscard]] auto TimeAt(size_t index) const noexcept -> Timestamp;
+
+    [[nodiscard]] auto ValueAt(size_t index) const noexcept -> T;
+
+    /**
+     * Raw samples of an implicit timebase, in point order, so they can be drawn without reading any timestamp.
+     * Points outside of these spans must be read through TimeAt and ValueAt.
+     */
+    [[nodiscard]] auto UniformSpans() const -> std::vector<UniformSpan>;
+
+    /**
+     * Whether every point read through this view so far is consistent, i.e. none of them was overwritten.
+     */
+    [[nodiscard]] auto IsIntact() const noexcept -> bool;
+
+private:
+    struct Segment {
+        size_t m_Level;
+        uint64_t m_Begin;
+        uint64_t m_End;
+        size_t m_FirstPoint;
+    };
+
+    struct HistorySegment {
+        std::shared_ptr<const SeriesArchive::DecodedChunk<T>> m_Chunk;
+        size_t m_Begin;
+        size_t m_FirstPoint;
+    };
+
+    [[nodiscard]] auto Locate(size_t &index) const noexcept -> const Segment &;
+
+    [[nodiscard]] auto LocateHistory(size_t &index) const noexcept -> const HistorySegment &;
+
+    std::shared_ptr<const SeriesStorage<T>> m_Storage;
+    std::shared_ptr<const SeriesArchive> m_Archive;
+    std::vector<HistorySegment> m_History;
+    size_t m_HistorySize = 0;
+    Segment m_Segments[MAX_SEGMENTS]{};
+    size_t m_SegmentCount = 0;
+    size_t m_Size = 0;
+};
+
+/**
+ * Value type independent part of a series, through which the chart manages series of any value type.
+ */
+class SeriesBase {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    explicit SeriesBase(const std::string &label);
+
+    virtual ~SeriesBase() = default;
+
+    [[nodiscard]] virtual auto GetValueType() const noexcept -> ValueType = 0;
+
+    [[nodiscard]] virtual auto LastValue() const -> std::optional<double> = 0;
+
+    /**
+     * Statistics of every sample added so far, maintained incrementally by AddData.
+     */
+    [[nodiscard]] auto Stats() const noexcept -> Statistics;
+
+    [[nodiscard]] virtual auto Capacity() const -> size_t = 0;
+
+    /**
+     * Change the number of samples kept by this series. The newest samples are preserved.
+     * The storage is reallocated by the producer when it adds the next sample.
+     */
+    auto SetCapacity(size_t capacity) -> void;
+
+    [[nodiscard]] virtual auto GetTimebase() const -> Timebase = 0;
+
+    /**
+     * Switch between explicit and implicit timestamps, applied like SetCapacity. A series with an implicit
+     * timebase falls back to the explicit one by itself when its samples jitter too much.
+     */
+    auto SetTimebase(Timebase timebase) -> void;
+
+    /**
+     * Capacity used by series constructed without an explicit one.
+     */
+    [[nodiscard]] static auto DefaultCapacity() noexcept -> size_t;
+
+    static auto SetDefaultCapacity(size_t capacity) noexcept -> void;
+
+    /**
+     * Timebase used by newly constructed series.
+     */
+    [[nodiscard]] static auto DefaultTimebase() noexcept -> Timebase;
+
+    static auto SetDefaultTimebase(Timebase timebase) noexcept -> void;
 
     [[nodiscard]] auto Label() const noexcept -> std::string;
 
     auto SetLabel(const std::string &label) -> void;
 
+    /**
+     * Start spilling the history of this series to a memory-mapped file, see ArchivePending.
+     * Views then include archived samples older than the storage.
+     */
+    auto EnableArchive(const std::filesystem::path &path) -> void;
+
+    [[nodiscard]] auto Archive() const -> std::shared_ptr<const SeriesArchive>;
+
+    /**
+     * Seal every complete chunk of samples not archived yet and append it to the archive.
+     * It reads the storage like any other reader, so it never blocks the producer. It must always be called from
+     * the same thread and often enough that the producer doesn't overwrite samples before they are archived.
+     * @return false if the archive couldn't be written.
+     */
+    virtual auto ArchivePending() -> bool = 0;
+
+protected:
+    std::atomic<size_t> m_PendingCapacity{0};
+    std::atomic<bool> m_TimebasePending{false};
+    std::atomic<Timebase> m_PendingTimebase{Timebase::Explicit};
+    RunningStatistics m_RunningStatistics;        ///< Only touched by the producer
+    SeqLock<Statistics> m_Statistics;
+    std::shared_ptr<SeriesArchive> m_Archive;       ///< Accessed through std::atomic_load/store
+
 private:
-    mutable std::mutex m_Mutex;
-    std::vector<Dot> m_Data;
     mutable std::mutex m_LabelMutex;
     std::string m_Label;
+
+    static std::atomic<size_t> s_DefaultCapacity;
+    static std::atomic<Timebase> s_DefaultTimebase;
 };
 
+/**
+ * Series of samples stored as T, one of the types of ValueType, e.g. int16 for a 16-bit ADC channel.
+ */
+template<class T>
+class Series : public SeriesBase {
+public:
+    explicit Series(const std::string &label);
+
+    Series(const std::string &label, size_t capacity);
+
+    [[nodiscard]] auto GetValueType() const noexcept -> ValueType override { return ValueTypeOf<T>::VALUE; }
+
+    /**
+     * Append a sample. It never blocks, but must always be called from the same (producer) thread.
+     * Samples are kept in time order: one older than the newest sample is stored at the time of the newest.
+     */
+    auto AddData(const TimeType &time, T value) -> void;
+
+    /**
+     * Append `count` samples taken `period` apart, the first one at `time`, like AddData. The statistics are
+     * published once for all of them. A batch starting no later than the newest sample, e.g. back-dated from its
+     * reception with some jitter, is moved to start one period after it.
+     */
+    auto AddData(const TimeType &time, Duration period, const T *values, size_t count) -> void;
+
+    /**
+     * Get the points in [beginTime, endTime] without copying them. It never blocks the producer.
+     * @param resolution When non-zero, e.g. the pixel width of the plot, the finest level of detail with at most
+     * that many entries over the range is used. Newer samples not yet summarized at that level are taken from
+     * finer levels.
+     */
+    [[nodiscard]] auto View(const TimeType &beginTime,
+                            const TimeType &endTime,
+                            size_t resolution = 0) const -> SeriesView<T>;
+
+    [[nodiscard]] auto LastValue() const -> std::optional<double> override;
+
+    [[nodiscard]] auto Capacity() const -> size_t override;
+
+    [[nodiscard]] auto GetTimebase() const -> Timebase override;
+
+    auto ArchivePending() -> bool override;
+
+    /**
+     * Current storage, for readers following the samples by sequence number rather than by time.
+     * It is replaced when the capacity or the timebase changes.
+     */
+    [[nodiscard]] auto Storage() const -> std::shared_ptr<const SeriesStorage<T>>;
+
+private:
+
+    /**
+     * Replace the storage by a new one, keeping the newest samples that fit.
+     */
+    auto Reallocate(size_t capacity, Timebase timebase) -> void;
+
+    /**
+     * Append a sample without publishing the statistics.
+     */
+    auto Push(const TimeType &time, T value) -> void;
+
+    std::shared_ptr<SeriesStorage<T>> m_Storage;       ///< Published storage, accessed through std::atomic_load/store
+    std::shared_ptr<SeriesStorage<T>> m_WriterStorage; ///< Producer's own reference to the same storage
+    Timestamp m_NewestTime = std::numeric_limits<Timestamp>::min(); ///< Only touched by the producer
+
+    // Archiving progress, only touched by the archiving thread.
+    std::shared_ptr<const SeriesStorage<T>> m_ArchivedStorage;
+    uint64_t m_ArchivedSeq = 0;
+    Timestamp m_ArchivedTime = std::numeric_limits<Timestamp>::min();
+    std::vector<Timestamp> m_ArchiveTimes;
+    std::vector<T> m_ArchiveValues;
+};
+
+/**
+ * Call `visitor` with the series cast to its concrete Series<T> type.
+ */
+template<class Visitor>
+auto VisitSeries(const SeriesBase &series, Visitor &&visitor) {
+    switch (series.GetValueType()) {
+        case ValueType::Int16:
+            return visitor(static_cast<const Series<int16_t> &>(series));
+        case ValueType::Int32:
+            return visitor(static_cast<const Series<int32_t> &>(series));
+        case ValueType::Double:
+            return visitor(static_cast<const Series<double> &>(series));
+        case ValueType::Float:
+        default:
+            return visitor(static_cast<const Series<float> &>(series));
+    }
+}
+
 #endif // BUSPLOT_SERIES_HPP
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include <algorithm>
+
+#include "series_registry.hpp"
+
+SeriesRegistry::SeriesRegistry() : m_Table(ID_COUNT), m_Snapshot(std::make_shared<const Snapshot>()) {}
+
+auto SeriesRegistry::Insert(uint16_t seriesId, std::shared_ptr<SeriesBase> series) -> bool {
+    if (!series || m_Table[seriesId]) {
+        return false;
+    }
+    Assign(seriesId, std::move(series));
+    return true;
+}
+
+auto SeriesRegistry::Assign(uint16_t seriesId, std::shared_ptr<SeriesBase> series) -> void {
+    if (!series) {
+        Erase(seriesId);
+        return;
+    }
+    auto snapshot = *GetSnapshot();
+    const auto it = std::lower_bound(snapshot.begin(), snapshot.end(), seriesId,
+                                     [](const Entry &entry, uint16_t id) { return entry.m_Id < id; });
+    if (it != snapshot.end() && it->m_Id == seriesId) {
+        it->m_Series = series;
+    } else {
+        snapshot.insert(it, Entry{seriesId, series});
+    }
+    m_Table[seriesId] = std::move(series);
+    Publish(std::move(snapshot));
+}
+
+auto SeriesRegistry::Erase(uint16_t seriesId) -> bool {
+    if (!m_Table[seriesId]) {
+        return false;
+    }
+    auto snapshot = *GetSnapshot();
+    snapshot.erase(std::lower_bound(snapshot.begin(), snapshot.end(), seriesId,
+                                    [](const Entry &entry, uint16_t id) { return entry.m_Id < id; }));
+    m_Table[seriesId].reset();
+    Publish(std::move(snapshot));
+    return true;
+}
+
+auto SeriesRegistry::GetSnapshot() const -> std::shared_ptr<const Snapshot> {
+    return std::atomic_load(&m_Snapshot);
+}
+
+auto SeriesRegistry::Size() const -> size_t {
+    return GetSnapshot()->size();
+}
+
+auto SeriesRegistry::Publish(Snapshot snapshot) -> void {
+    std::atomic_store(&m_Snapshot, std::shared_ptr<const Snapshot>(std::make_shared<Snapshot>(std::move(snapshot))));
+}
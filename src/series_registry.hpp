@@ -0,0 +1,80 @@
+#ifndef BUSPLOT_SERIES_REGISTRY_HPP
+#define BUSPLOT_SERIES_REGISTRY_HPP
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "series.hpp"
+
+/**
+ * Series of the variables, indexed by variable id.
+ *
+ * Ids are 16-bit, so the series live in a dense table of ID_COUNT entries: looking one up is a single array
+ * access, without hashing or touching a reference count. Other threads see the series through an immutable
+ * snapshot sorted by id, which is copied and republished on every change (copy-on-write). Changes are rare
+ * compared with frames, so a reader never waits for the writer, and the writer never waits for a reader to be
+ * done with a snapshot: the series it removed stay alive until the last snapshot holding them is released.
+ *
+ * Find, Insert, Assign and Erase must always be called from the same (writer) thread. GetSnapshot, ForEach and
+ * Size may be called from any thread.
+ */
+class SeriesRegistry {
+public:
+    static constexpr size_t ID_COUNT = size_t(1) << 16;
+
+    struct Entry {
+        uint16_t m_Id;
+        std::shared_ptr<SeriesBase> m_Series;
+    };
+
+    using Snapshot = std::vector<Entry>;
+
+    SeriesRegistry();
+
+    /**
+     * @return The series of `seriesId`, an empty pointer if there is none. Only for the writer thread.
+     */
+    [[nodiscard]] auto Find(uint16_t seriesId) const noexcept -> const std::shared_ptr<SeriesBase> & {
+        return m_Table[seriesId];
+    }
+
+    /**
+     * @return false if `seriesId` already has a series, or `series` is empty.
+     */
+    auto Insert(uint16_t seriesId, std::shared_ptr<SeriesBase> series) -> bool;
+
+    /**
+     * Insert a series, or replace the existing one.
+     */
+    auto Assign(uint16_t seriesId, std::shared_ptr<SeriesBase> series) -> void;
+
+    auto Erase(uint16_t seriesId) -> bool;
+
+    /**
+     * Series as of the last change, in id order. It stays valid however long it is kept.
+     */
+    [[nodiscard]] auto GetSnapshot() const -> std::shared_ptr<const Snapshot>;
+
+    [[nodiscard]] auto Size() const -> size_t;
+
+    /**
+     * Call `visitor(seriesId, series)` for every series of the current snapshot, in id order.
+     */
+    template<class Visitor>
+    auto ForEach(Visitor &&visitor) const -> void {
+        const auto snapshot = GetSnapshot();
+        for (const auto &entry : *snapshot) {
+            visitor(entry.m_Id, entry.m_Series);
+        }
+    }
+
+private:
+    auto Publish(Snapshot snapshot) -> void;
+
+    std::vector<std::shared_ptr<SeriesBase>> m_Table;   ///< Only touched by the writer
+    std::shared_ptr<const Snapshot> m_Snapshot;         ///< Accessed through std::atomic_load/store
+};
+
+#endif // BUSPLOT_SERIES_REGISTRY_HPP
@@ -0,0 +1,56 @@
+#include <algorithm>
+
+#include "statistics.hpp"
+
+RunningStatistics::RunningStatistics(size_t window)
+        : m_Window(std::max<size_t>(window, 1)),
+          m_WindowValues(m_Window),
+          m_WindowMin(m_Window),
+          m_WindowMax(m_Window) {}
+
+auto RunningStatistics::Push(double value) noexcept -> void {
+    const auto seq = m_Count++;
+    if (seq == 0) {
+        m_Min = value;
+        m_Max = value;
+    } else {
+        m_Min = std::min(m_Min, value);
+        m_Max = std::max(m_Max, value);
+    }
+    const auto delta = value - m_Mean;
+    m_Mean += delta / static_cast<double>(m_Count);
+    m_SquaredDistance += delta * (value - m_Mean);
+
+    auto &slot = m_WindowValues[seq % m_Window];
+    if (seq >= m_Window) {
+        m_WindowSum -= slot;
+    }
+    slot = value;
+    m_WindowSum += value;
+    if ((seq + 1) % m_Window == 0) {
+        // Adding and subtracting accumulates rounding errors, which summing the window afresh drops.
+        m_WindowSum = 0;
+        for (const auto windowValue : m_WindowValues) {
+            m_WindowSum += windowValue;
+        }
+    }
+    m_WindowMin.Push(seq, value);
+    m_WindowMax.Push(seq, value);
+}
+
+auto RunningStatistics::Snapshot() const noexcept -> Statistics {
+    Statistics statistics;
+    statistics.m_Count = m_Count;
+    if (m_Count == 0) {
+        return statistics;
+    }
+    statistics.m_Min = m_Min;
+    statistics.m_Max = m_Max;
+    statistics.m_Mean = m_Mean;
+    statistics.m_Variance = m_SquaredDistance / static_cast<double>(m_Count);
+    statistics.m_WindowCount = std::min<uint64_t>(m_Count, m_Window);
+    statistics.m_WindowMin = m_WindowMin.Value();
+    statistics.m_WindowMax = m_WindowMax.Value();
+    statistics.m_WindowMean = m_WindowSum / static_cast<double>(statistics.m_WindowCount);
+    return statistics;
+}
@@ -0,0 +1,93 @@
+#ifndef BUSPLOT_STATISTICS_HPP
+#define BUSPLOT_STATISTICS_HPP
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Snapshot of the statistics of a series.
+ */
+struct Statistics {
+    uint64_t m_Count{};
+    double m_Min{};
+    double m_Max{};
+    double m_Mean{};
+    double m_Variance{}; ///< Population variance
+    uint64_t m_WindowCount{}; ///< Number of samples in the window, at most the window size
+    double m_WindowMin{};
+    double m_WindowMax{};
+    double m_WindowMean{};
+};
+
+/**
+ * Sliding window extremum over the last `window` values, backed by a fixed-capacity monotonic deque.
+ * `Compare(a, b)` tells whether `a` should be preferred over `b`, e.g. std::less for the minimum.
+ */
+template<class Compare>
+class MonotonicWindow {
+public:
+    explicit MonotonicWindow(size_t window) : m_Window(window), m_Entries(window + 1) {}
+
+    auto Push(uint64_t seq, double value) noexcept -> void {
+        while (m_Size > 0 && !m_Compare(Back().m_Value, value)) {
+            --m_Size;
+        }
+        m_Entries[(m_Head + m_Size) % m_Entries.size()] = Entry{seq, value};
+        ++m_Size;
+        while (m_Entries[m_Head].m_Seq + m_Window <= seq) {
+            m_Head = (m_Head + 1) % m_Entries.size();
+            --m_Size;
+        }
+    }
+
+    [[nodiscard]] auto Value() const noexcept -> double { return m_Entries[m_Head].m_Value; }
+
+private:
+    struct Entry {
+        uint64_t m_Seq;
+        double m_Value;
+    };
+
+    [[nodiscard]] auto Back() const noexcept -> const Entry & {
+        return m_Entries[(m_Head + m_Size - 1) % m_Entries.size()];
+    }
+
+    size_t m_Window;
+    std::vector<Entry> m_Entries;
+    size_t m_Head = 0;
+    size_t m_Size = 0;
+    Compare m_Compare;
+};
+
+/**
+ * Statistics updated in O(1) for each new sample: overall count, extrema, mean and variance (Welford's method),
+ * and extrema and mean over the last `window` samples. The window sum is recomputed once every `window` samples,
+ * amortized O(1), so that the window mean doesn't drift. Nothing is allocated after construction.
+ * Every value type is accumulated as double, which holds int32 values exactly.
+ */
+class RunningStatistics {
+public:
+    static constexpr size_t DEFAULT_WINDOW = 1000;
+
+    explicit RunningStatistics(size_t window = DEFAULT_WINDOW);
+
+    auto Push(double value) noexcept -> void;
+
+    [[nodiscard]] auto Snapshot() const noexcept -> Statistics;
+
+private:
+    size_t m_Window;
+    uint64_t m_Count = 0;
+    double m_Min = 0;
+    double m_Max = 0;
+    double m_Mean = 0;
+    double m_SquaredDistance = 0; ///< Sum of squared distances from the mean
+    std::vector<double> m_WindowValues;
+    double m_WindowSum = 0;       ///< Updated incrementally, recomputed whenever the window wraps
+    MonotonicWindow<std::less<>> m_WindowMin;
+    MonotonicWindow<std::greater<>> m_WindowMax;
+};
+
+#endif // BUSPLOT_STATISTICS_HPP
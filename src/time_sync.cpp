@@ -0,0 +1,56 @@
+#include <spdlog/spdlog.h>
+
+#include "time_sync.hpp"
+
+TimeSync::TimeSync(SerialRPC *rpc) : m_SerialRPC(*rpc) {
+}
+
+TimeSync::~TimeSync() {
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_Condition.notify_all();
+    if (m_PingThread.joinable()) {
+        m_PingThread.join();
+    }
+}
+
+auto TimeSync::HandleDeviceClock(const DeviceClockReq &req) -> void {
+    m_DeviceClock.SetFrequency(req.m_Frequency);
+    if (!m_Pinging) {
+        if (m_PingThread.joinable()) {
+            m_PingThread.join(); ///< It stopped by itself after a failure
+        }
+        m_Pinging = true;
+        m_PingThread = std::thread(&TimeSync::PingLoop, this);
+    }
+}
+
+auto TimeSync::HandleEcho(const TimeSyncEchoReq &echo) -> void {
+    const auto receiveTime = std::chrono::time_point_cast<Duration>(Clock::now());
+    m_DeviceClock.AddRoundTrip(echo.m_Tick, TimeType(Duration(static_cast<Timestamp>(echo.m_HostTime))), receiveTime);
+}
+
+auto TimeSync::GetDeviceClock() noexcept -> DeviceClock & {
+    return m_DeviceClock;
+}
+
+auto TimeSync::PingLoop() -> void {
+    uint32_t sequence = 0;
+    std::unique_lock lock(m_Mutex);
+    while (!m_Stopping) {
+        lock.unlock();
+        const auto sendTime = std::chrono::time_point_cast<Duration>(Clock::now());
+        try {
+            m_SerialRPC.Request(TimeSyncReq{static_cast<uint64_t>(sendTime.time_since_epoch().count()), sequence++});
+        } catch (std::exception &err) {
+            spdlog::error("TimeSync: Ping failed, stop pinging until the device clock is announced again: {}",
+                          err.what());
+            m_Pinging = false;
+            return;
+        }
+        lock.lock();
+        m_Condition.wait_for(lock, PING_INTERVAL, [&] { return m_Stopping; });
+    }
+}
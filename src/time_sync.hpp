@@ -0,0 +1,55 @@
+#ifndef BUSPLOT_TIME_SYNC_HPP
+#define BUSPLOT_TIME_SYNC_HPP
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+#include "rpc_protocol.hpp"
+#include "serial_rpc.hpp"
+#include "device_clock.hpp"
+
+/**
+ * Synchronizes the device clock with round trips: once the device announced its clock with DeviceClockReq, a ping
+ * TimeSyncReq stamped with the host time is sent every PING_INTERVAL, and each TimeSyncEchoReq stamped with the
+ * tick of the device is added to the DeviceClock.
+ *
+ * The pings are sent from a thread of their own, the handlers are called from the thread receiving the samples.
+ */
+class TimeSync {
+public:
+    static constexpr auto PING_INTERVAL = std::chrono::milliseconds(100);
+
+    explicit TimeSync(SerialRPC *rpc);
+
+    ~TimeSync();
+
+    /**
+     * Map the ticks at the frequency of the device clock, and start pinging the device unless it is being pinged,
+     * e.g. again after a ping failed to be sent.
+     */
+    auto HandleDeviceClock(const DeviceClockReq &req) -> void;
+
+    auto HandleEcho(const TimeSyncEchoReq &echo) -> void;
+
+    /**
+     * Only used by the thread receiving the samples, except DeviceClock::Stats.
+     */
+    [[nodiscard]] auto GetDeviceClock() noexcept -> DeviceClock &;
+
+private:
+    auto PingLoop() -> void;
+
+    SerialRPC &m_SerialRPC;
+    DeviceClock m_DeviceClock;
+    std::thread m_PingThread;
+    std::atomic<bool> m_Pinging{false}; ///< Cleared by the ping thread when it stops by itself
+    std::mutex m_Mutex;                 ///< Guards m_Stopping
+    std::condition_variable m_Condition;
+    bool m_Stopping = false;
+};
+
+#endif // BUSPLOT_TIME_SYNC_HPP
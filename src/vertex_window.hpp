@@ -0,0 +1,60 @@
+#ifndef BUSPLOT_VERTEX_WINDOW_HPP
+#define BUSPLOT_VERTEX_WINDOW_HPP
+
+#include <limits>
+#include <cstdint>
+
+#include "series.hpp"
+
+/**
+ * Samples of a storage mirrored as vertices whose timestamps are 32-bit offsets from an origin, see
+ * GpuLineRenderer.
+ *
+ * The origin is the newest sample when the window is placed, and only samples at most MAX_TIME_OFFSET older are
+ * kept. Samples appended later fit until they are MAX_TIME_OFFSET newer than the origin, so a series is placed
+ * again once per MAX_TIME_OFFSET of its time whatever its sample rate, and a plot start within MAX_TIME_OFFSET
+ * of the origin can be subtracted from any vertex time without overflowing 32 bits.
+ */
+struct VertexWindow {
+    static constexpr Timestamp MAX_TIME_OFFSET = Timestamp(1) << 30;
+
+    uint64_t m_First = 0;   ///< Sequence number of the oldest sample kept
+    Timestamp m_Origin = 0; ///< Timestamp of vertex time 0
+    Timestamp m_Horizon = std::numeric_limits<Timestamp>::min(); ///< Older samples exist but were left out
+
+    /**
+     * Window ending at the newest of `committed` samples.
+     */
+    template<class T>
+    [[nodiscard]] static auto Place(const SeriesStorage<T> &storage, uint64_t committed) noexcept -> VertexWindow {
+        const auto oldest = storage.Oldest(committed);
+        if (committed == oldest) {
+            return VertexWindow{committed};
+        }
+        const auto origin = storage.TimeAt(committed - 1);
+        // Timestamps never decrease, find the first one recent enough.
+        auto first = oldest;
+        auto last = committed - 1;
+        while (first < last) {
+            const auto mid = first + (last - first) / 2;
+            if (storage.TimeAt(mid) < origin - MAX_TIME_OFFSET) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+        return VertexWindow{first, origin,
+                            first > oldest ? origin - MAX_TIME_OFFSET : std::numeric_limits<Timestamp>::min()};
+    }
+
+    /**
+     * Whether a sample appended after the window can be given a vertex time relative to its origin.
+     */
+    [[nodiscard]] auto Fits(Timestamp time) const noexcept -> bool { return time - m_Origin <= MAX_TIME_OFFSET; }
+
+    [[nodiscard]] auto VertexTime(Timestamp time) const noexcept -> int32_t {
+        return static_cast<int32_t>(time - m_Origin);
+    }
+};
+
+#endif // BUSPLOT_VERTEX_WINDOW_HPP
@@ -0,0 +1,114 @@
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <functional>
+
+#include "../src/gorilla.hpp"
+
+static constexpr size_t CHUNK_SAMPLES = 4096;
+static constexpr size_t CHUNK_COUNT = 256;
+static constexpr int64_t PERIOD_US = 1000; ///< 1 kHz
+
+template<class T>
+struct Workload {
+    const char *m_Name;
+    int64_t m_JitterUs;
+    std::function<T(size_t, std::mt19937 &)> m_Value;
+};
+
+/**
+ * Encode every chunk of a workload, decode it back and compare bit by bit.
+ * @return false on any mismatch.
+ */
+template<class T>
+auto Run(const Workload<T> &workload) -> bool {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int64_t> jitter(-workload.m_JitterUs, workload.m_JitterUs);
+    const auto sampleCount = CHUNK_SAMPLES * CHUNK_COUNT;
+    std::vector<int64_t> times(sampleCount);
+    std::vector<T> values(sampleCount);
+    const int64_t start = 1600000000000000;
+    for (size_t i = 0; i < sampleCount; ++i) {
+        times[i] = start + static_cast<int64_t>(i) * PERIOD_US + jitter(random);
+        values[i] = workload.m_Value(i, random);
+    }
+
+    std::vector<std::vector<uint8_t>> encoded(CHUNK_COUNT);
+    size_t bytes = 0;
+    for (size_t chunk = 0; chunk < CHUNK_COUNT; ++chunk) {
+        const auto offset = chunk * CHUNK_SAMPLES;
+        Gorilla::Encode(times.data() + offset, values.data() + offset, CHUNK_SAMPLES, encoded[chunk]);
+        bytes += encoded[chunk].size();
+    }
+
+    std::vector<int64_t> decodedTimes(CHUNK_SAMPLES);
+    std::vector<T> decodedValues(CHUNK_SAMPLES);
+    bool ok = true;
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t chunk = 0; chunk < CHUNK_COUNT; ++chunk) {
+        const auto offset = chunk * CHUNK_SAMPLES;
+        if (!Gorilla::Decode(encoded[chunk].data(), encoded[chunk].size(), CHUNK_SAMPLES,
+                             decodedTimes.data(), decodedValues.data())) {
+            spdlog::error("{}: Failed to decode chunk {}", workload.m_Name, chunk);
+            ok = false;
+            continue;
+        }
+        for (size_t i = 0; i < CHUNK_SAMPLES; ++i) {
+            if (decodedTimes[i] != times[offset + i] ||
+                std::memcmp(&decodedValues[i], &values[offset + i], sizeof(T)) != 0) {
+                spdlog::error("{}: Mismatch at sample {}", workload.m_Name, offset + i);
+                ok = false;
+                break;
+            }
+        }
+    }
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    const auto rawBytes = sampleCount * (sizeof(int64_t) + sizeof(T));
+    spdlog::info("{:<24} {:6.2f} bytes/sample ({:5.1f}x smaller), decode {:7.1f} Msamples/s",
+                 workload.m_Name,
+                 static_cast<double>(bytes) / static_cast<double>(sampleCount),
+                 static_cast<double>(rawBytes) / static_cast<double>(bytes),
+                 static_cast<double>(sampleCount) / seconds / 1e6);
+    return ok;
+}
+
+int main() {
+    const Workload<float> workloads[] = {
+        {"constant", 0, [](size_t, std::mt19937 &) { return 3.3f; }},
+        {"slow sine", 0, [](size_t i, std::mt19937 &) {
+            return static_cast<float>(std::sin(static_cast<double>(i) * 1e-3));
+        }},
+        {"slow sine, jitter", 20, [](size_t i, std::mt19937 &) {
+            return static_cast<float>(std::sin(static_cast<double>(i) * 1e-3));
+        }},
+        {"quantized ADC", 0, [](size_t i, std::mt19937 &random) {
+            std::normal_distribution<double> noise(0.0, 2.0);
+            return std::round(2048.0f + 500.0f * static_cast<float>(std::sin(static_cast<double>(i) * 1e-3)) +
+                              static_cast<float>(noise(random)));
+        }},
+        {"noisy, jitter", 200, [](size_t, std::mt19937 &random) {
+            std::normal_distribution<float> noise(0.0f, 1.0f);
+            return noise(random);
+        }},
+    };
+    bool ok = true;
+    for (const auto &workload : workloads) {
+        ok = Run(workload) && ok;
+    }
+    const Workload<int16_t> adc{"int16 ADC", 0, [](size_t i, std::mt19937 &random) {
+        std::normal_distribution<double> noise(0.0, 2.0);
+        return static_cast<int16_t>(std::round(2048.0 + 500.0 * std::sin(static_cast<double>(i) * 1e-3) +
+                                               noise(random)));
+    }};
+    ok = Run(adc) && ok;
+    const Workload<double> fine{"double slow sine", 0, [](size_t i, std::mt19937 &) {
+        return std::sin(static_cast<double>(i) * 1e-3);
+    }};
+    ok = Run(fine) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+#include <spdlog/spdlog.h>
+
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include "../src/device_clock.hpp"
+
+static constexpr double DRIFT = 40e-6;                 ///< Device clock running fast
+static constexpr double DRIFT_SWING = 10e-6;           ///< Drift changing with the temperature
+static constexpr double DRIFT_CYCLE = 1800e6;          ///< Microseconds
+static constexpr int64_t FRAME_PERIOD = 1000;          ///< Microseconds between two frames
+static constexpr int64_t PING_PERIOD = 100;            ///< Frames between two round trips
+static constexpr int64_t FRAME_COUNT = 3600 * 1000;    ///< An hour of frames
+static constexpr int64_t WARMUP_FRAMES = 30 * 1000;
+static constexpr int64_t MIN_LATENCY = 200;
+static constexpr double MEAN_LATENCY = 1000.;
+static constexpr double SPIKE_RATE = 0.001;
+static constexpr int64_t SPIKE_LATENCY = 20000;
+static constexpr int64_t MAX_ONE_WAY_ERROR = 1000;     ///< Microseconds
+static constexpr int64_t MAX_SYNCED_ERROR = 80;   ///< The fastest ways there and back differ by up to ~100 us
+
+/**
+ * Device clock of 1 MHz drifting from host time, starting just before its ticks wrap around.
+ */
+class SimulatedDevice {
+public:
+    explicit SimulatedDevice(bool driftSwings) : m_DriftSwings(driftSwings) {}
+
+    /**
+     * Tick at `time` microseconds after the start.
+     */
+    [[nodiscard]] auto TickAt(int64_t time) const -> uint32_t {
+        constexpr double PI = 3.14159265358979323846;
+        const auto microseconds = static_cast<double>(time);
+        auto ticks = microseconds * (1 + DRIFT);
+        if (m_DriftSwings) {
+            // The drift swings like a sine, the ticks gained like the integral of it.
+            ticks += DRIFT_SWING * DRIFT_CYCLE / (2 * PI) * (1 - std::cos(2 * PI * microseconds / DRIFT_CYCLE));
+        }
+        return TICK_START + static_cast<uint32_t>(std::llround(ticks));
+    }
+
+private:
+    static constexpr uint32_t TICK_START = UINT32_MAX - 5000000;
+    bool m_DriftSwings;
+};
+
+/**
+ * Latency of a frame, mostly short but with a long tail and rare spikes.
+ */
+class Latency {
+public:
+    [[nodiscard]] auto Next() -> int64_t {
+        auto latency = MIN_LATENCY + static_cast<int64_t>(m_Exponential(m_Random));
+        if (m_Chance(m_Random) < SPIKE_RATE) {
+            latency += SPIKE_LATENCY;
+        }
+        return latency;
+    }
+
+private:
+    std::mt19937 m_Random{42};
+    std::exponential_distribution<double> m_Exponential{1. / MEAN_LATENCY};
+    std::uniform_real_distribution<double> m_Chance{0., 1.};
+};
+
+/**
+ * Map the ticks of an hour of frames sent every FRAME_PERIOD, received in order after a random latency, and with
+ * round trips every PING_PERIOD frames if `roundTrips`.
+ * @return false if mapped times went backward or were off by more than `maxError`.
+ */
+static auto Run(bool roundTrips, int64_t maxError) -> bool {
+    const int64_t hostStart = 1600000000000000;
+    DeviceClock clock(1000000);
+    SimulatedDevice device(roundTrips);
+    Latency latency;
+    int64_t lastReceive = 0;
+    int64_t lastMapped = 0;
+    int64_t worstError = 0;
+    double errorSum = 0;
+    double absErrorSum = 0;
+    bool monotonic = true;
+    for (int64_t frame = 0; frame < FRAME_COUNT; ++frame) {
+        const auto sendTime = frame * FRAME_PERIOD;
+        if (roundTrips && frame % PING_PERIOD == 0) {
+            const auto pingTime = sendTime + FRAME_PERIOD / 2;
+            const auto deviceTime = pingTime + latency.Next();
+            const auto tick = device.TickAt(deviceTime);
+            clock.AddRoundTrip(tick, TimeType(Duration(hostStart + pingTime)),
+                               TimeType(Duration(hostStart + deviceTime + latency.Next())));
+        }
+        const auto tick = device.TickAt(sendTime);
+        lastReceive = std::max(lastReceive, sendTime + latency.Next());
+        clock.Observe(tick, TimeType(Duration(hostStart + lastReceive)));
+        const auto mapped = clock.ToHostTime(tick).time_since_epoch().count() - hostStart;
+        monotonic = monotonic && (frame == 0 || mapped > lastMapped);
+        lastMapped = mapped;
+        if (frame >= WARMUP_FRAMES) {
+            worstError = std::max(worstError, std::abs(mapped - sendTime));
+            errorSum += static_cast<double>(mapped - sendTime);
+            absErrorSum += static_cast<double>(std::abs(mapped - sendTime));
+        }
+    }
+    const auto stats = clock.Stats();
+    const auto measured = static_cast<double>(FRAME_COUNT - WARMUP_FRAMES);
+    spdlog::info("{}: mean error {:.1f} us, mean absolute error {:.1f} us, max error {} us, drift estimated at "
+                 "{:.2f} ppm, median round trip {} us", roundTrips ? "Round trips" : "One way", errorSum / measured,
+                 absErrorSum / measured, worstError, stats.m_DriftPpm, stats.m_MedianRoundTrip);
+    if (!monotonic) {
+        spdlog::error("Device clock test failed: later ticks mapped to earlier times.");
+        return false;
+    }
+    if (worstError > maxError) {
+        spdlog::error("Device clock test failed: error up to {} us.", worstError);
+        return false;
+    }
+    return true;
+}
+
+auto main() -> int {
+    if (!Run(false, MAX_ONE_WAY_ERROR) || !Run(true, MAX_SYNCED_ERROR)) {
+        return 1;
+    }
+
+    // The device restarting, its ticks start over and the mapping with them.
+    DeviceClock clock(1000000);
+    const int64_t hostStart = 1600000000000000;
+    clock.Observe(4000000000u, TimeType(Duration(hostStart)));
+    clock.Observe(1000, TimeType(Duration(hostStart + 5000000 + MIN_LATENCY)));
+    const auto restartError = clock.ToHostTime(1000).time_since_epoch().count() - hostStart - 5000000;
+    if (std::abs(restartError) > MAX_ONE_WAY_ERROR) {
+        spdlog::error("Device clock test failed: {} us off after the device restarted.", restartError);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <spdlog/spdlog.h>
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+
+#include "../src/downsample.hpp"
+
+static constexpr int64_t WIDTH = 640;
+static constexpr int64_t HEIGHT = 200;
+static constexpr size_t SAMPLE_COUNT = 200000;
+
+/**
+ * Monochrome canvas of WIDTH x HEIGHT pixels mapping [xMin, xMax) x [yMin, yMax] like a plot does.
+ */
+class Raster {
+public:
+    Raster(double xMin, double xMax, double yMin, double yMax)
+            : m_XMin(xMin), m_XScale(WIDTH / (xMax - xMin)), m_YMin(yMin), m_YScale((HEIGHT - 1) / (yMax - yMin)),
+              m_Pixels(WIDTH * HEIGHT, false) {}
+
+    /**
+     * Draw a polyline, snapping every point to its pixel and joining the pixels with Bresenham segments.
+     */
+    auto DrawLine(const std::vector<SamplePoint> &points) -> void {
+        for (size_t i = 1; i < points.size(); ++i) {
+            DrawSegment(PixelX(points[i - 1].m_X), PixelY(points[i - 1].m_Y),
+                        PixelX(points[i].m_X), PixelY(points[i].m_Y));
+        }
+    }
+
+    [[nodiscard]] auto Mismatches(const Raster &other) const -> size_t {
+        size_t count = 0;
+        for (size_t i = 0; i < m_Pixels.size(); ++i) {
+            count += m_Pixels[i] != other.m_Pixels[i];
+        }
+        return count;
+    }
+
+    [[nodiscard]] auto SetPixels() const -> size_t {
+        size_t count = 0;
+        for (const auto pixel : m_Pixels) {
+            count += pixel;
+        }
+        return count;
+    }
+
+private:
+    [[nodiscard]] auto PixelX(double x) const -> int64_t {
+        return static_cast<int64_t>(std::floor((x - m_XMin) * m_XScale));
+    }
+
+    [[nodiscard]] auto PixelY(double y) const -> int64_t {
+        return static_cast<int64_t>(std::floor((y - m_YMin) * m_YScale));
+    }
+
+    auto DrawSegment(int64_t x0, int64_t y0, int64_t x1, int64_t y1) -> void {
+        const auto dx = std::abs(x1 - x0);
+        const auto dy = -std::abs(y1 - y0);
+        const int64_t sx = x0 < x1 ? 1 : -1;
+        const int64_t sy = y0 < y1 ? 1 : -1;
+        auto error = dx + dy;
+        while (true) {
+            if (x0 >= 0 && x0 < WIDTH && y0 >= 0 && y0 < HEIGHT) {
+                m_Pixels[y0 * WIDTH + x0] = true;
+            }
+            if (x0 == x1 && y0 == y1) {
+                break;
+            }
+            const auto error2 = 2 * error;
+            if (error2 >= dy) {
+                error += dy;
+                x0 += sx;
+            }
+            if (error2 <= dx) {
+                error += dx;
+                y0 += sy;
+            }
+        }
+    }
+
+    double m_XMin;
+    double m_XScale;
+    double m_YMin;
+    double m_YScale;
+    std::vector<bool> m_Pixels;
+};
+
+struct Signal {
+    const char *m_Name;
+    std::function<double(size_t)> m_Value;
+};
+
+/**
+ * Rasterize a signal in full and downsampled, over its whole range and zoomed in on a part of it, which leaves
+ * points on both sides of the plot.
+ * @return false if M4 changed any pixel.
+ */
+static auto Check(const Signal &signal) -> bool {
+    std::vector<SamplePoint> points(SAMPLE_COUNT);
+    double yMin = signal.m_Value(0);
+    double yMax = yMin;
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        points[i] = SamplePoint{static_cast<double>(i) * 0.001, signal.m_Value(i)};
+        yMin = std::min(yMin, points[i].m_Y);
+        yMax = std::max(yMax, points[i].m_Y);
+    }
+    if (yMin == yMax) {
+        yMax = yMin + 1;
+    }
+    const auto getPoint = [&](size_t i) { return points[i]; };
+    const double ranges[2][2] = {{points.front().m_X, points.back().m_X + 0.001},
+                                 {points[SAMPLE_COUNT / 3].m_X + 0.0004, points[SAMPLE_COUNT / 2].m_X + 0.0007}};
+    bool passed = true;
+    std::vector<SamplePoint> reduced;
+    for (const auto &range : ranges) {
+        Raster full(range[0], range[1], yMin, yMax);
+        full.DrawLine(points);
+
+        DownsampleM4(points.size(), getPoint, range[0], range[1], WIDTH, reduced);
+        Raster m4(range[0], range[1], yMin, yMax);
+        m4.DrawLine(reduced);
+        const auto m4Points = reduced.size();
+        const auto m4Mismatches = full.Mismatches(m4);
+
+        DownsampleLTTB(points.size(), getPoint, WIDTH, reduced);
+        Raster lttb(range[0], range[1], yMin, yMax);
+        lttb.DrawLine(reduced);
+
+        spdlog::info("{:<8} [{:.1f}, {:.1f}]: {} pixels, M4 {} points {} mismatches, LTTB {} mismatches ({:.1f}%)",
+                     signal.m_Name, range[0], range[1], full.SetPixels(), m4Points, m4Mismatches,
+                     full.Mismatches(lttb), 100. * full.Mismatches(lttb) / full.SetPixels());
+        if (m4Mismatches != 0) {
+            spdlog::error("M4 output differs from the full-resolution line.");
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+auto main() -> int {
+    spdlog::set_level(spdlog::level::info);
+    std::mt19937_64 engine(42);
+    std::normal_distribution<double> noise(0., 1.);
+    std::vector<double> noiseValues(SAMPLE_COUNT);
+    for (auto &value : noiseValues) {
+        value = noise(engine);
+    }
+    const Signal signals[] = {
+            {"Noise",  [&](size_t i) { return noiseValues[i]; }},
+            {"Sine",   [](size_t i) { return std::sin(static_cast<double>(i) * 0.0005); }},
+            {"Chirp",  [](size_t i) { return std::sin(static_cast<double>(i) * static_cast<double>(i) * 1e-8); }},
+            {"Spikes", [](size_t i) { return i % 9973 == 0 ? 100. : 0.; }},
+            {"Steps",  [](size_t i) { return static_cast<double>((i / 5000) % 7); }},
+            {"Int16",  [&](size_t i) { return std::round(noiseValues[i] * 300. + 1000. * std::sin(i * 1e-4)); }},
+    };
+    bool passed = true;
+    for (const auto &signal : signals) {
+        passed = Check(signal) && passed;
+    }
+    if (!passed) {
+        spdlog::error("Downsample test failed.");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,205 @@
+#include <spdlog/spdlog.h>
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+
+#include <array>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <cstring>
+
+#include "../src/rpc_protocol.hpp"
+#include "../src/frame_scanner.hpp"
+#include "../src/serial_rpc.hpp"
+
+namespace asio = boost::asio;
+using asio::ip::tcp;
+
+static constexpr size_t FRAME_COUNT = 2000000;
+
+/**
+ * What both receivers extract from the frames, to check they received the same ones.
+ */
+struct Received {
+    size_t m_Frames = 0;
+    size_t m_Handlers = 0;  ///< Read handlers run
+    double m_Sum = 0;
+};
+
+/**
+ * The receive state machine SerialRPC used before FrameScanner: one read for the SOF byte, one for the header,
+ * one for the body and tail.
+ */
+class StateMachineReceiver {
+public:
+    StateMachineReceiver(tcp::socket &socket, Received &received) : m_Socket(socket), m_Received(received) {}
+
+    auto Start() -> void { ReadAsync(m_SOFBuffer, &StateMachineReceiver::ReadSOFHandler); }
+
+private:
+    template<class BufferType, size_t N, class HandlerType>
+    auto ReadAsync(std::array<BufferType, N> &buffer, HandlerType handler) -> void {
+        asio::async_read(m_Socket, asio::buffer(buffer), asio::transfer_exactly(sizeof(BufferType) * N),
+                         boost::bind(handler, this, asio::placeholders::error,
+                                     asio::placeholders::bytes_transferred));
+    }
+
+    auto ReadSOFHandler(const boost::system::error_code &err, size_t) -> void {
+        ++m_Received.m_Handlers;
+        if (err) {
+            return;
+        }
+        if (m_SOFBuffer[0] == SOF) {
+            ReadAsync(m_HeaderBuffer, &StateMachineReceiver::ReadHeaderHandler);
+        } else {
+            ReadAsync(m_SOFBuffer, &StateMachineReceiver::ReadSOFHandler);
+        }
+    }
+
+    auto ReadHeaderHandler(const boost::system::error_code &err, size_t) -> void {
+        ++m_Received.m_Handlers;
+        if (err) {
+            return;
+        }
+        if (m_HeaderBuffer[0].m_Command != UpdateVariableReq::COMMAND
+            || m_HeaderBuffer[0].m_DataLength != sizeof(UpdateVariableReq)) {
+            ReadAsync(m_SOFBuffer, &StateMachineReceiver::ReadSOFHandler);
+            return;
+        }
+        asio::async_read(m_Socket, asio::buffer(m_BodyBuffer),
+                         asio::transfer_exactly(sizeof(UpdateVariableReq) + sizeof(FrameTail)),
+                         boost::bind(&StateMachineReceiver::ReadBodyHandler, this, asio::placeholders::error,
+                                     asio::placeholders::bytes_transferred));
+    }
+
+    auto ReadBodyHandler(const boost::system::error_code &err, size_t) -> void {
+        ++m_Received.m_Handlers;
+        if (err) {
+            return;
+        }
+        // The frame is checked as bytes, the body and tail having been read together.
+        constexpr auto BODY_OFFSET = sizeof(SOF) + sizeof(FrameHeader);
+        std::array<uint8_t, BODY_OFFSET + sizeof(UpdateVariableReq) + sizeof(FrameTail)> frame{SOF};
+        std::memcpy(frame.data() + sizeof(SOF), m_HeaderBuffer.data(), sizeof(FrameHeader));
+        std::memcpy(frame.data() + BODY_OFFSET, m_BodyBuffer.data(), frame.size() - BODY_OFFSET);
+        if (CRC::VerifyCRC16Checksum(frame.data(), frame.size())) {
+            float value;
+            std::memcpy(&value, frame.data() + BODY_OFFSET + offsetof(UpdateVariableReq, m_Value), sizeof(value));
+            ++m_Received.m_Frames;
+            m_Received.m_Sum += value;
+        }
+        ReadAsync(m_SOFBuffer, &StateMachineReceiver::ReadSOFHandler);
+    }
+
+    tcp::socket &m_Socket;
+    Received &m_Received;
+    std::array<uint8_t, 1> m_SOFBuffer{};
+    std::array<FrameHeader, 1> m_HeaderBuffer{};
+    std::array<uint8_t, 512> m_BodyBuffer{};
+};
+
+/**
+ * Reads like SerialRPC does now: whatever is available into a FrameScanner, then every frame in it.
+ */
+class ScanningReceiver {
+public:
+    ScanningReceiver(tcp::socket &socket, Received &received) : m_Socket(socket), m_Received(received) {}
+
+    auto Start() -> void { ReadSome(); }
+
+private:
+    auto ReadSome() -> void {
+        m_Socket.async_read_some(asio::buffer(m_Scanner->WritePointer(), m_Scanner->WritableBytes()),
+                                 boost::bind(&ScanningReceiver::ReadSomeHandler, this, asio::placeholders::error,
+                                             asio::placeholders::bytes_transferred));
+    }
+
+    auto ReadSomeHandler(const boost::system::error_code &err, size_t len) -> void {
+        ++m_Received.m_Handlers;
+        if (err) {
+            return;
+        }
+        m_Scanner->Commit(len);
+        m_Scanner->Scan([this](const FrameScanner::Frame &frame) {
+            if (frame.m_Command != UpdateVariableReq::COMMAND || frame.m_Length != sizeof(UpdateVariableReq)) {
+                return;
+            }
+            UpdateVariableReq request;
+            std::memcpy(&request, frame.m_Body, sizeof(request));
+            ++m_Received.m_Frames;
+            m_Received.m_Sum += request.m_Value;
+        });
+        ReadSome();
+    }
+
+    tcp::socket &m_Socket;
+    Received &m_Received;
+    std::unique_ptr<FrameScanner> m_Scanner = std::make_unique<FrameScanner>();
+};
+
+/**
+ * Send `stream` over a loopback connection and receive it with `Receiver`.
+ * @return Seconds until the sender closed the connection and every byte was received.
+ */
+template<class Receiver>
+static auto Receive(const std::vector<uint8_t> &stream, Received &received) -> double {
+    asio::io_context context;
+    tcp::acceptor acceptor(context, tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    tcp::socket reader(context);
+    std::thread sender([&stream, port = acceptor.local_endpoint().port()] {
+        asio::io_context senderContext;
+        tcp::socket writer(senderContext);
+        writer.connect(tcp::endpoint(asio::ip::address_v4::loopback(), port));
+        writer.set_option(tcp::no_delay(true));
+        // Written in small pieces, like a device sends a few frames at a time.
+        for (size_t offset = 0; offset < stream.size(); offset += 4096) {
+            asio::write(writer, asio::buffer(stream.data() + offset, std::min<size_t>(4096, stream.size() - offset)));
+        }
+    });
+    acceptor.accept(reader);
+    const auto begin = std::chrono::steady_clock::now();
+    Receiver receiver(reader, received);
+    receiver.Start();
+    context.run();
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    sender.join();
+    return elapsed;
+}
+
+auto main() -> int {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> values(-1000.f, 1000.f);
+    std::vector<uint8_t> stream;
+    stream.reserve(FRAME_COUNT * sizeof(RPCRequest<UpdateVariableReq>));
+    double sum = 0;
+    for (size_t i = 0; i < FRAME_COUNT; ++i) {
+        const UpdateVariableReq request{static_cast<uint16_t>(i % 16), values(random)};
+        uint8_t frame[FrameScanner::MAX_FRAME_BYTES];
+        const auto frameBytes = SerialRPC::MakeFrame(request, frame);
+        stream.insert(stream.end(), frame, frame + frameBytes);
+        sum += request.m_Value;
+    }
+
+    Received stateMachine;
+    const auto stateMachineSeconds = Receive<StateMachineReceiver>(stream, stateMachine);
+    Received scanning;
+    const auto scanningSeconds = Receive<ScanningReceiver>(stream, scanning);
+
+    const auto report = [&](const char *name, const Received &received, double seconds) {
+        spdlog::info("{:>13}: {:7.1f} MB/s, {:6.2f} M frames/s, {:9} read handlers, {:.2f} frames per handler",
+                     name, static_cast<double>(stream.size()) / seconds / 1e6,
+                     static_cast<double>(received.m_Frames) / seconds / 1e6, received.m_Handlers,
+                     static_cast<double>(received.m_Frames) / static_cast<double>(received.m_Handlers));
+    };
+    spdlog::info("{} frames, {} bytes over loopback TCP", FRAME_COUNT, stream.size());
+    report("State machine", stateMachine, stateMachineSeconds);
+    report("FrameScanner", scanning, scanningSeconds);
+    if (stateMachine.m_Frames != FRAME_COUNT || scanning.m_Frames != FRAME_COUNT
+        || stateMachine.m_Sum != sum || scanning.m_Sum != sum) {
+        spdlog::error("Receivers lost frames: {} and {} of {}.", stateMachine.m_Frames, scanning.m_Frames,
+                      FRAME_COUNT);
+        return 1;
+    }
+    return 0;
+}
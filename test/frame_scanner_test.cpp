@@ -0,0 +1,160 @@
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <cstring>
+
+#include "../src/rpc_protocol.hpp"
+#include "../src/frame_scanner.hpp"
+#include "../src/serial_rpc.hpp"
+
+static constexpr size_t FRAME_COUNT = 60000;
+static constexpr double CORRUPTION_RATE = 0.02;    ///< Frames with one byte changed
+static constexpr double NOISE_RATE = 0.02;         ///< Frames followed by a burst of noise
+static constexpr double TRUNCATION_RATE = 0.01;    ///< Frames cut short before their tail, the rest never sent
+static constexpr size_t MAX_NOISE_BYTES = 32;
+static constexpr size_t MAX_READ_BYTES = 700;
+
+/**
+ * A frame sent, told apart from the others by its command and variable id.
+ */
+struct SentFrame {
+    uint16_t m_Command;
+    uint16_t m_VariableId;
+    bool m_Intact;
+};
+
+template<class ReqType>
+static auto Append(std::vector<uint8_t> &stream, const ReqType &request) -> size_t {
+    uint8_t frame[FrameScanner::MAX_FRAME_BYTES];
+    const auto frameBytes = SerialRPC::MakeFrame(request, frame);
+    stream.insert(stream.end(), frame, frame + frameBytes);
+    return frameBytes;
+}
+
+auto main() -> int {
+    spdlog::set_level(spdlog::level::info);
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> chance(0., 1.);
+    std::uniform_int_distribution<int> byteValue(0, 255);
+
+    // Frames of every length, some corrupted or truncated, with noise between them, which is often SOF.
+    std::vector<uint8_t> stream;
+    std::vector<SentFrame> sent;
+    for (size_t i = 0; i < FRAME_COUNT; ++i) {
+        const auto variableId = static_cast<uint16_t>(i);
+        const auto begin = stream.size();
+        uint16_t command;
+        switch (i % 5) {
+            case 0:
+                command = UpdateVariableReq::COMMAND;
+                Append(stream, UpdateVariableReq{variableId, static_cast<float>(i)});
+                break;
+            case 1:
+                command = UpdateVariableInt16Req::COMMAND;
+                Append(stream, UpdateVariableInt16Req{variableId, static_cast<int16_t>(SOF)});
+                break;
+            case 2:
+                command = UpdateVariableDoubleReq::COMMAND;
+                Append(stream, UpdateVariableDoubleReq{variableId, static_cast<double>(i)});
+                break;
+            case 3:
+                command = VariableAliasReq::COMMAND;
+                Append(stream, VariableAliasReq{variableId, {SOF, 0xff, SOF}});
+                break;
+            default: {
+                command = UpdateVariableSamplesReq::COMMAND;
+                UpdateVariableSamplesReq samples{variableId, 1000, static_cast<uint8_t>(1 + i % 62)};
+                std::fill_n(samples.m_Values, samples.m_Count, static_cast<float>(SOF));
+                Append(stream, samples);
+                break;
+            }
+        }
+        bool intact = true;
+        if (chance(random) < CORRUPTION_RATE) {
+            std::uniform_int_distribution<size_t> position(begin, stream.size() - 1);
+            stream[position(random)] ^= static_cast<uint8_t>(1 + byteValue(random) % 255);
+            intact = false;
+        } else if (chance(random) < TRUNCATION_RATE) {
+            std::uniform_int_distribution<size_t> length(1, stream.size() - begin - sizeof(FrameTail) - 1);
+            stream.resize(begin + length(random));
+            intact = false;
+        }
+        sent.push_back(SentFrame{command, variableId, intact});
+        if (chance(random) < NOISE_RATE) {
+            std::uniform_int_distribution<size_t> noiseBytes(1, MAX_NOISE_BYTES);
+            for (auto n = noiseBytes(random); n > 0; --n) {
+                stream.push_back(chance(random) < 0.5 ? SOF : static_cast<uint8_t>(byteValue(random)));
+            }
+        }
+    }
+
+    // Received in reads of random sizes, the intact frames must all be found in order.
+    auto scanner = std::make_unique<FrameScanner>();
+    scanner->Expect(UpdateVariableReq::COMMAND, sizeof(UpdateVariableReq));
+    scanner->Expect(UpdateVariableInt16Req::COMMAND, sizeof(UpdateVariableInt16Req));
+    scanner->Expect(UpdateVariableDoubleReq::COMMAND, sizeof(UpdateVariableDoubleReq));
+    scanner->Expect(VariableAliasReq::COMMAND, sizeof(VariableAliasReq));
+    scanner->Expect(UpdateVariableSamplesReq::COMMAND, FrameLength<UpdateVariableSamplesReq>::MIN,
+                    FrameLength<UpdateVariableSamplesReq>::MAX);
+    std::uniform_int_distribution<size_t> readBytes(1, MAX_READ_BYTES);
+    size_t offset = 0;
+    size_t next = 0;
+    size_t missed = 0;
+    size_t spurious = 0;
+    const auto handleFrame = [&](const FrameScanner::Frame &frame) {
+        if (frame.m_Length < sizeof(uint16_t)) {
+            ++spurious;
+            return;
+        }
+        uint16_t variableId;
+        std::memcpy(&variableId, frame.m_Body, sizeof(variableId));
+        size_t match = next;
+        while (match < sent.size()
+               && (sent[match].m_Command != frame.m_Command || sent[match].m_VariableId != variableId)) {
+            ++match;
+        }
+        // The header and CRC16 may let through a candidate which isn't a frame, though very rarely.
+        if (match == sent.size()) {
+            ++spurious;
+            return;
+        }
+        for (; next < match; ++next) {
+            missed += sent[next].m_Intact;
+        }
+        ++next;
+    };
+    while (offset < stream.size()) {
+        const auto bytes = std::min({readBytes(random), scanner->WritableBytes(), stream.size() - offset});
+        std::memcpy(scanner->WritePointer(), stream.data() + offset, bytes);
+        scanner->Commit(bytes);
+        scanner->Scan(handleFrame);
+        offset += bytes;
+    }
+    for (; next < sent.size(); ++next) {
+        missed += sent[next].m_Intact;
+    }
+
+    size_t intact = 0;
+    for (const auto &frame : sent) {
+        intact += frame.m_Intact;
+    }
+    const auto counters = scanner->Counters();
+    spdlog::info("{} frames sent, {} intact, {} received: {} recovered after a dropped candidate, {} candidates dropped, "
+                 "{} bytes skipped", FRAME_COUNT, intact, counters.m_Frames, counters.m_Recovered,
+                 counters.m_Dropped, counters.m_SkippedBytes);
+    if (missed > 0) {
+        spdlog::error("Frame scanner test failed: {} intact frames missed.", missed);
+        return 1;
+    }
+    if (spurious > 1) {
+        spdlog::error("Frame scanner test failed: {} frames received which weren't sent.", spurious);
+        return 1;
+    }
+    if (counters.m_Recovered == 0) {
+        spdlog::error("Frame scanner test failed: no frame recovered after a dropped candidate.");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include <spdlog/spdlog.h>
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include "../src/plot_preparer.hpp"
+
+static constexpr uint16_t SERIES_COUNT = 8;
+static constexpr int64_t SAMPLE_COUNT = 20000;
+static constexpr int64_t PERIOD = 1000;
+static constexpr size_t COLUMNS = 640;
+static constexpr size_t FRAME_COUNT = 2000;
+static constexpr auto READY_TIMEOUT = std::chrono::seconds(10);
+
+static auto TimeOf(int64_t i) -> TimeType {
+    return TimeType(Duration(1600000000000000 + i * PERIOD));
+}
+
+/**
+ * Counts the ready callbacks and lets the test wait for the next one.
+ */
+class ReadyCounter {
+public:
+    auto Notify() -> void {
+        {
+            std::lock_guard lock(m_Mutex);
+            ++m_Count;
+        }
+        m_Condition.notify_all();
+    }
+
+    [[nodiscard]] auto Count() -> size_t {
+        std::lock_guard lock(m_Mutex);
+        return m_Count;
+    }
+
+    [[nodiscard]] auto WaitBeyond(size_t count) -> bool {
+        std::unique_lock lock(m_Mutex);
+        return m_Condition.wait_for(lock, READY_TIMEOUT, [&] { return m_Count > count; });
+    }
+
+private:
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    size_t m_Count = 0;
+};
+
+/**
+ * Prepared points must be the points of the view, read in full without downsampling.
+ */
+static auto CheckExact(PlotPreparer &preparer, const SeriesRegistry::Snapshot &snapshot,
+                       const PlotPreparer::Request &request) -> bool {
+    for (const auto &entry : snapshot) {
+        const auto &series = static_cast<const Series<float> &>(*entry.m_Series);
+        const auto view = series.View(request.m_BeginTime, request.m_EndTime, request.m_Resolution);
+        const auto &points = preparer.Acquire(entry.m_Series.get());
+        if (points.size() != view.Size()) {
+            spdlog::error("{}: {} points prepared, the view has {}.", series.Label(), points.size(), view.Size());
+            return false;
+        }
+        for (size_t i = 0; i < points.size(); ++i) {
+            if (points[i].m_X != static_cast<double>(view.TimeAt(i)) / 1000000.
+                || points[i].m_Y != static_cast<double>(view.ValueAt(i))) {
+                spdlog::error("{}: point {} differs from the view.", series.Label(), i);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+auto main() -> int {
+    spdlog::set_level(spdlog::level::info);
+    SeriesRegistry registry;
+    for (uint16_t seriesId = 0; seriesId < SERIES_COUNT; ++seriesId) {
+        auto series = std::make_shared<Series<float>>(fmt::format("var{}", seriesId), 1 << 16);
+        if (seriesId % 2) {
+            series->SetTimebase(Timebase::Implicit);
+        }
+        for (int64_t i = 0; i < SAMPLE_COUNT; ++i) {
+            series->AddData(TimeOf(i), static_cast<float>((i * (seriesId + 1)) % 977));
+        }
+        registry.Insert(seriesId, series);
+    }
+
+    ReadyCounter ready;
+    PlotPreparer preparer(2);
+    preparer.SetReadyCallback([&] { ready.Notify(); });
+
+    // Prepared in full, the points are exactly those of the views.
+    const auto snapshot = registry.GetSnapshot();
+    const PlotPreparer::Request request{TimeOf(0), TimeOf(SAMPLE_COUNT), COLUMNS, 0, Downsampling::Off};
+    preparer.Submit(snapshot, request);
+    if (!ready.WaitBeyond(0) || !CheckExact(preparer, *snapshot, request)) {
+        spdlog::error("Plot preparer test failed: points of the first request.");
+        return 1;
+    }
+
+    // Nothing changed, preparing the same request again must not ask for another frame.
+    preparer.Submit(snapshot, request);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    if (ready.Count() != 1) {
+        spdlog::error("Plot preparer test failed: ready callback without any change.");
+        return 1;
+    }
+
+    // Frames submitted while the series keep growing, faster than they are prepared: points are always in time order,
+    // and every series gets newer points, not only those at the front of the snapshot.
+    std::vector<double> firstNewest;
+    for (const auto &entry : *snapshot) {
+        firstNewest.push_back(preparer.Acquire(entry.m_Series.get()).back().m_X);
+    }
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        for (int64_t i = SAMPLE_COUNT; !done; ++i) {
+            for (const auto &entry : *snapshot) {
+                static_cast<Series<float> &>(*entry.m_Series).AddData(TimeOf(i), static_cast<float>(i % 977));
+            }
+        }
+    });
+    size_t preparedFrames = 0;
+    bool ordered = true;
+    for (size_t frame = 0; frame < FRAME_COUNT; ++frame) {
+        preparer.Submit(snapshot, PlotPreparer::Request{TimeOf(0), TimeOf(SAMPLE_COUNT * 1000), COLUMNS,
+                                                        COLUMNS * 16, frame % 2 ? Downsampling::M4
+                                                                                : Downsampling::LTTB});
+        for (const auto &entry : *snapshot) {
+            const auto &points = preparer.Acquire(entry.m_Series.get());
+            preparedFrames += !points.empty();
+            for (size_t i = 1; i < points.size(); ++i) {
+                ordered = ordered && points[i - 1].m_X <= points[i].m_X;
+            }
+        }
+    }
+    done = true;
+    producer.join();
+    bool advanced = true;
+    for (size_t i = 0; i < snapshot->size(); ++i) {
+        const auto &points = preparer.Acquire((*snapshot)[i].m_Series.get());
+        advanced = advanced && !points.empty() && points.back().m_X > firstNewest[i];
+    }
+    spdlog::info("{} frames, {} series plotted from prepared points, {} ready callbacks",
+                 FRAME_COUNT, preparedFrames, ready.Count());
+    if (!ordered) {
+        spdlog::error("Plot preparer test failed: prepared points out of order.");
+        return 1;
+    }
+    if (!advanced) {
+        spdlog::error("Plot preparer test failed: series left with the points of the first request.");
+        return 1;
+    }
+    return 0;
+}
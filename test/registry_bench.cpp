@@ -0,0 +1,99 @@
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+#include "../src/series_registry.hpp"
+
+static constexpr size_t LOOKUP_COUNT = 20000000;
+static constexpr size_t ITERATION_COUNT = 20000;
+
+/**
+ * Time `operation` and return nanoseconds per call, `count` being the number of calls it makes.
+ */
+template<class Operation>
+static auto NanosecondsPerCall(size_t count, Operation &&operation) -> double {
+    const auto begin = std::chrono::steady_clock::now();
+    operation();
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin);
+    return elapsed.count() / static_cast<double>(count);
+}
+
+/**
+ * Compare the previous registry, an unordered_map handing out shared_ptr copies, with SeriesRegistry, for
+ * `variableCount` variables with ids spread over the whole id range.
+ * @return false if both don't find the same series.
+ */
+static auto Run(size_t variableCount) -> bool {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<unsigned> idDistribution(0, SeriesRegistry::ID_COUNT - 1);
+    std::unordered_map<int, std::shared_ptr<SeriesBase>> map;
+    SeriesRegistry registry;
+    std::vector<uint16_t> ids;
+    while (ids.size() < variableCount) {
+        const auto seriesId = static_cast<uint16_t>(idDistribution(random));
+        auto series = std::make_shared<Series<float>>(fmt::format("var{}", seriesId), 16);
+        if (registry.Insert(seriesId, series)) {
+            map.emplace(seriesId, series);
+            ids.push_back(seriesId);
+        }
+    }
+    std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+    std::vector<uint16_t> lookups(1 << 16);
+    for (auto &seriesId : lookups) {
+        seriesId = ids[pick(random)];
+    }
+
+    size_t mapFound = 0;
+    const auto mapLookup = NanosecondsPerCall(LOOKUP_COUNT, [&] {
+        for (size_t i = 0; i < LOOKUP_COUNT; ++i) {
+            const auto it = map.find(lookups[i & (lookups.size() - 1)]);
+            const std::shared_ptr<SeriesBase> series = it == map.end() ? nullptr : it->second;
+            mapFound += series->GetValueType() == ValueType::Float;
+        }
+    });
+    size_t registryFound = 0;
+    const auto registryLookup = NanosecondsPerCall(LOOKUP_COUNT, [&] {
+        for (size_t i = 0; i < LOOKUP_COUNT; ++i) {
+            registryFound += registry.Find(lookups[i & (lookups.size() - 1)])->GetValueType() == ValueType::Float;
+        }
+    });
+
+    size_t mapVisited = 0;
+    const auto mapIteration = NanosecondsPerCall(ITERATION_COUNT, [&] {
+        for (size_t i = 0; i < ITERATION_COUNT; ++i) {
+            for (const auto &item : map) {
+                mapVisited += item.second->GetValueType() == ValueType::Float;
+            }
+        }
+    });
+    size_t registryVisited = 0;
+    const auto registryIteration = NanosecondsPerCall(ITERATION_COUNT, [&] {
+        for (size_t i = 0; i < ITERATION_COUNT; ++i) {
+            registry.ForEach([&](uint16_t, const std::shared_ptr<SeriesBase> &series) {
+                registryVisited += series->GetValueType() == ValueType::Float;
+            });
+        }
+    });
+
+    spdlog::info("{:5} variables: lookup {:6.2f} ns -> {:6.2f} ns, iteration {:8.1f} ns -> {:8.1f} ns",
+                 variableCount, mapLookup, registryLookup, mapIteration, registryIteration);
+    if (mapFound != registryFound || mapVisited != registryVisited) {
+        spdlog::error("The registries don't hold the same series.");
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::info);
+    spdlog::info("unordered_map<int, shared_ptr> -> SeriesRegistry");
+    bool ok = true;
+    for (const auto variableCount : {8, 64, 512, 4096}) {
+        ok = Run(variableCount) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include <spdlog/spdlog.h>
+
+#include <thread>
+#include <atomic>
+#include <limits>
+
+#include "../src/series.hpp"
+
+static constexpr size_t CAPACITY = 1024;
+static constexpr uint64_t SAMPLE_COUNT = 20000000;
+static constexpr uint64_t VALUE_MASK = (1 << 24) - 1; ///< Floats represent every integer up to 2^24 exactly
+static constexpr uint64_t RUN_LENGTH = 100; ///< Timestamps skip one microsecond after that many samples
+
+struct ReaderResult {
+    uint64_t m_CheckedViews{};
+    uint64_t m_CheckedSamples{};
+    uint64_t m_OverrunViews{};
+    uint64_t m_TornViews{};
+};
+
+static auto TimeOf(uint64_t i) -> uint64_t {
+    return i + i / RUN_LENGTH;
+}
+
+/**
+ * Sample `i` has timestamp `t = TimeOf(i)` and value `t & VALUE_MASK`, so any sample mixing two writes is
+ * detectable. The regular skips in the timestamps split an implicit timebase into runs.
+ */
+template<class T>
+auto Producer(Series<T> &series, std::atomic<bool> &done) -> void {
+    for (uint64_t i = 1; i <= SAMPLE_COUNT; ++i) {
+        const auto time = TimeOf(i);
+        series.AddData(TimeType(Duration(time)), static_cast<T>(time & VALUE_MASK));
+        if (i == SAMPLE_COUNT / 2) {
+            series.SetCapacity(CAPACITY * 2);
+        }
+    }
+    done = true;
+}
+
+template<class T>
+auto Reader(const Series<T> &series, const std::atomic<bool> &done) -> ReaderResult {
+    ReaderResult result;
+    while (!done) {
+        const auto view = series.View(TimeType(Duration(0)), TimeType::max());
+        bool consistent = true;
+        for (size_t i = 0; i < view.Size(); ++i) {
+            const auto time = view.TimeAt(i);
+            const auto value = view.ValueAt(i);
+            if (value != static_cast<T>(static_cast<uint64_t>(time) & VALUE_MASK)
+                || (i > 0 && (time <= view.TimeAt(i - 1) || time > view.TimeAt(i - 1) + 2))) {
+                consistent = false;
+            }
+        }
+        if (!view.IsIntact()) {
+            ++result.m_OverrunViews; ///< The producer lapped us, the view is rejected as a whole
+            continue;
+        }
+        if (!consistent) {
+            ++result.m_TornViews;
+        }
+        ++result.m_CheckedViews;
+        result.m_CheckedSamples += view.Size();
+    }
+    return result;
+}
+
+template<class T>
+auto Run(Timebase timebase) -> bool {
+    SeriesBase::SetDefaultTimebase(timebase);
+    Series<T> series("stress", CAPACITY);
+    std::atomic<bool> done = false;
+    ReaderResult result;
+    std::thread reader([&]() { result = Reader(series, done); });
+    std::thread producer(Producer<T>, std::ref(series), std::ref(done));
+    producer.join();
+    reader.join();
+
+    spdlog::info("Checked {} views ({} samples), {} overrun, {} torn.",
+                 result.m_CheckedViews, result.m_CheckedSamples, result.m_OverrunViews, result.m_TornViews);
+    const auto last = series.LastValue();
+    if (!last || *last != static_cast<double>(TimeOf(SAMPLE_COUNT) & VALUE_MASK)) {
+        spdlog::error("Last value mismatch.");
+        return false;
+    }
+    if (series.Capacity() != CAPACITY * 2
+        || series.View(TimeType(Duration(0)), TimeType::max()).Size() != CAPACITY * 2) {
+        spdlog::error("Capacity change was not applied.");
+        return false;
+    }
+    if (series.GetTimebase() != timebase) {
+        spdlog::error("The timebase changed.");
+        return false;
+    }
+    if (result.m_TornViews != 0 || result.m_CheckedViews == 0) {
+        spdlog::error("Stress test failed.");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Samples added out of order, like batches back-dated from their reception, are stored in time order.
+ */
+static auto CheckOrder() -> bool {
+    Series<float> series("order", CAPACITY);
+    const float values[4] = {1, 2, 3, 4};
+    series.AddData(TimeType(Duration(10000)), Duration(1000), values, 4);
+    series.AddData(TimeType(Duration(12500)), Duration(1000), values, 4); ///< Overlaps the previous batch
+    series.AddData(TimeType(Duration(5000)), 5.f);
+    const auto view = series.View(TimeType(Duration(0)), TimeType::max());
+    for (size_t i = 1; i < view.Size(); ++i) {
+        if (view.TimeAt(i) < view.TimeAt(i - 1)) {
+            spdlog::error("Samples out of order: {} after {}.", view.TimeAt(i), view.TimeAt(i - 1));
+            return false;
+        }
+    }
+    if (view.Size() != 9 || view.TimeAt(4) != 14000 || view.TimeAt(8) != 17000) {
+        spdlog::error("Overlapping batch not moved after the previous one.");
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::info);
+    if (!CheckOrder()) {
+        return 1;
+    }
+    spdlog::info("Explicit timebase:");
+    if (!Run<float>(Timebase::Explicit)) {
+        return 1;
+    }
+    spdlog::info("Implicit timebase:");
+    if (!Run<float>(Timebase::Implicit)) {
+        return 1;
+    }
+    spdlog::info("Int32 values:");
+    return Run<int32_t>(Timebase::Explicit) ? 0 : 1;
+}
@@ -28,12 +28,46 @@ auto Client() -> void {
     spdlog::trace("Client: Serial port connect success.");
     rpc.Request(VariableAliasReq{1, "Foo"});
     rpc.Request(VariableAliasReq{2, "Bar"});
+    rpc.Request(VariableAliasReq{3, "Adc"});
+    rpc.Request(VariableAliasReq{4, "Temp"});
+    rpc.Request(VariableAliasReq{5, "Load"});
+    // Foo and Bar are sampled at 1 kHz and sent in batches every BATCH_PERIOD, the slower variables once per batch.
+    // Samples are stamped with the ticks of a 1 MHz device clock, counting from the start of the simulator.
+    constexpr auto BATCH_PERIOD = std::chrono::milliseconds(10);
+    constexpr uint32_t SAMPLE_PERIOD = 1000;
+    constexpr auto SAMPLE_COUNT = static_cast<uint8_t>(Duration(BATCH_PERIOD).count() / SAMPLE_PERIOD);
+    static_assert(SAMPLE_COUNT <= UpdateVariableTickedSamplesReq::MAX_COUNT);
+    const auto deviceStart = std::chrono::steady_clock::now();
+    const auto deviceTick = [deviceStart]() {
+        return static_cast<uint32_t>(
+                std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now() - deviceStart).count());
+    };
+    // Pings of the host are echoed at once with the tick they were received at.
+    rpc.RegisterMessage<TimeSyncReq>([&rpc, &deviceTick](const TimeSyncReq &req) {
+        rpc.Request(TimeSyncEchoReq{req.m_HostTime, deviceTick()});
+    });
+    rpc.StartGrabbing();
+    rpc.Request(DeviceClockReq{1000000});
     while (true) {
         auto t = std::chrono::time_point_cast<Duration>(Clock::now());
         auto s = static_cast<double>(t.time_since_epoch().count()) / 1000000.f;
-        rpc.Request(UpdateVariableReq{1, static_cast<float>(50.f * std::sin(s * 40.f) + 10.f)});
-        rpc.Request(UpdateVariableReq{2, static_cast<float>(10.f * std::cos(s * 20.f) + 10.f)});
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const auto tick = deviceTick();
+        const auto firstTick = tick - SAMPLE_PERIOD * (SAMPLE_COUNT - 1);
+        UpdateVariableTickedSamplesReq foo{1, firstTick, SAMPLE_PERIOD, SAMPLE_COUNT};
+        UpdateVariableTickedSamplesReq bar{2, firstTick, SAMPLE_PERIOD, SAMPLE_COUNT};
+        for (uint8_t i = 0; i < SAMPLE_COUNT; ++i) {
+            const auto sampleTime = s - static_cast<double>((SAMPLE_COUNT - 1 - i) * SAMPLE_PERIOD) / 1000000.;
+            foo.m_Values[i] = static_cast<float>(50.f * std::sin(sampleTime * 40.f) + 10.f);
+            bar.m_Values[i] = static_cast<float>(10.f * std::cos(sampleTime * 20.f) + 10.f);
+        }
+        rpc.Request(foo);
+        rpc.Request(bar);
+        rpc.Request(UpdateVariableInt16Req{3, static_cast<int16_t>(2048. + 1000. * std::sin(s * 5.))});
+        UpdateVariablesTickedReq slow{tick, 2};
+        slow.m_Samples[0] = {4, static_cast<float>(25. + 0.5 * std::sin(s * 0.1))};
+        slow.m_Samples[1] = {5, static_cast<float>(50. + 40. * std::sin(s * 0.5))};
+        rpc.Request(slow);
+        std::this_thread::sleep_for(BATCH_PERIOD);
     }
 }
 
@@ -0,0 +1,80 @@
+#include <spdlog/spdlog.h>
+
+#include <cstdlib>
+
+#include "../src/vertex_window.hpp"
+
+static constexpr Timestamp START = 1600000000000000;
+static constexpr Timestamp PERIOD = 1000000;               ///< A sample per second, the storage spans 18 hours
+static constexpr uint64_t SAMPLE_COUNT = 4 * SeriesBase::DEFAULT_CAPACITY;
+static constexpr uint64_t SAMPLES_PER_FRAME = 10;
+
+/**
+ * Follow a slow series the way GpuLineRenderer uploads it, frame after frame.
+ * @return false if a vertex time didn't fit the window, or the window was placed more often than once per
+ * MAX_TIME_OFFSET of samples.
+ */
+static auto Run(Timebase timebase) -> bool {
+    SeriesStorage<float> storage(SeriesBase::DEFAULT_CAPACITY, timebase);
+    VertexWindow window;
+    uint64_t uploaded = 0;
+    size_t placements = 0;
+    bool placed = false;
+    for (uint64_t seq = 0; seq < SAMPLE_COUNT; ++seq) {
+        // A little jitter, which the implicit timebase absorbs.
+        if (!storage.Push(START + static_cast<Timestamp>(seq) * PERIOD + static_cast<Timestamp>(seq % 3) * 1000,
+                          static_cast<float>(seq % 977))) {
+            spdlog::error("Vertex window test failed: sample {} not stored.", seq);
+            return false;
+        }
+        if ((seq + 1) % SAMPLES_PER_FRAME) {
+            continue;
+        }
+        const auto committed = storage.Committed();
+        if (!placed || uploaded < storage.Oldest(committed) || !window.Fits(storage.TimeAt(committed - 1))) {
+            window = VertexWindow::Place(storage, committed);
+            uploaded = window.m_First;
+            placed = true;
+            ++placements;
+            if (window.m_First > storage.Oldest(committed)
+                && storage.TimeAt(window.m_First - 1) >= window.m_Horizon) {
+                spdlog::error("Vertex window test failed: sample {} left out of the window.", window.m_First - 1);
+                return false;
+            }
+        }
+        for (; uploaded < committed; ++uploaded) {
+            const auto time = storage.TimeAt(uploaded);
+            const auto offset = time - window.m_Origin;
+            if (std::abs(offset) > VertexWindow::MAX_TIME_OFFSET || window.VertexTime(time) != offset) {
+                spdlog::error("Vertex window test failed: sample {} is {} us from the origin.", uploaded, offset);
+                return false;
+            }
+        }
+    }
+    const auto span = static_cast<Timestamp>(SAMPLE_COUNT) * PERIOD;
+    const auto maxPlacements = static_cast<size_t>(span / VertexWindow::MAX_TIME_OFFSET) + 1;
+    spdlog::info("{} timebase: window placed {} times over {} frames",
+                 timebase == Timebase::Explicit ? "Explicit" : "Implicit", placements,
+                 SAMPLE_COUNT / SAMPLES_PER_FRAME);
+    if (placements > maxPlacements) {
+        spdlog::error("Vertex window test failed: window placed {} times, expected at most {}.", placements,
+                      maxPlacements);
+        return false;
+    }
+    return true;
+}
+
+auto main() -> int {
+    if (!Run(Timebase::Explicit) || !Run(Timebase::Implicit)) {
+        return 1;
+    }
+
+    // An empty storage gives an empty window, which the first sample doesn't fit.
+    SeriesStorage<float> storage(16);
+    const auto window = VertexWindow::Place(storage, 0);
+    if (window.m_First != 0 || window.Fits(START)) {
+        spdlog::error("Vertex window test failed: window of an empty storage.");
+        return 1;
+    }
+    return 0;
+}